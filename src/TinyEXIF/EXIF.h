@@ -1,10 +1,13 @@
 #pragma once
 #define TINYEXIF_NO_XMP_SUPPORT  // 在包含头文件前定义 禁止xmp
 #include "TinyEXIF.h"  // 使用相对路径
+#include "../utils/MappedFile.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <cstdint>
 
 class EXIF {
 private:
@@ -15,32 +18,38 @@ private:
     bool m_isValid;  // 添加有效性标志
     
 public:
-EXIF(const std::string& imagePath) : m_imageWidth(0), m_imageHeight(0), m_isValid(false) 
+EXIF(const std::string& imagePath) : m_imagePath(imagePath), m_imageWidth(0), m_imageHeight(0), m_isValid(false) 
 {
-    std::ifstream input_file(imagePath, std::ios::binary);
-    if (!input_file) {
+    // 只映射文件头，TinyEXIF 只访问到 APP1 段（不超过 64KB）为止
+    MappedFile file(imagePath, 128 * 1024);
+    if (!file.isOpen()) {
         std::cerr << "Error: cannot open input file" << std::endl;
         return;
     }
-
-    // 获取文件大小（带错误检查）
-    input_file.seekg(0, std::ios::end);
-    size_t file_size = input_file.tellg();
-    if (file_size == static_cast<size_t>(-1)) {
-        std::cerr << "Error: failed to get file size" << std::endl;
-        return;
+    MappedReadGuard guard(file);
+    parse(file.data(), file.size());
+    if (guard.failed()) {
+        m_isValid = false;
     }
-    input_file.seekg(0, std::ios::beg);
+}
 
-    // 读取文件内容
-    std::vector<uint8_t> file_data(file_size);
-    if (!input_file.read(reinterpret_cast<char*>(file_data.data()), file_size)) {
-        std::cerr << "Error: failed to read file content" << std::endl;
+// 之后调用 parse 解析
+EXIF() : m_imageWidth(0), m_imageHeight(0), m_isValid(false) {}
+
+// 解析已在内存中的文件（例如与解码共用的映射），不拷贝数据
+EXIF(const unsigned char* data, size_t size) : m_imageWidth(0), m_imageHeight(0), m_isValid(false)
+{
+    if (!data || size == 0) {
+        std::cerr << "Error: empty input data" << std::endl;
         return;
+    }
+    parse(data, size);
 }
 
+void parse(const unsigned char* data, size_t size)
+{
     // 解析EXIF
-    if (info.parseFrom(file_data.data(), file_size) != TinyEXIF::PARSE_SUCCESS) {
+    if (info.parseFrom(data, static_cast<unsigned>(size)) != TinyEXIF::PARSE_SUCCESS) {
         std::cerr << "Error: EXIF parsing failed" << std::endl;
         m_isValid=false;
         return;
@@ -52,6 +61,81 @@ EXIF(const std::string& imagePath) : m_imageWidth(0), m_imageHeight(0), m_isVali
 }
     
     ~EXIF() = default;  // 使用默认析构函数
+
+    /**
+     * @brief 查找 IFD1 中嵌入的 JPEG 缩略图（TinyEXIF 不解析 IFD1）
+     * @param thumbnail 输出指向 data 内部的指针，不拷贝数据，使用期间 data 须保持有效
+     * @return 找到完整的 JPEG 缩略图时返回 true
+     */
+    static bool findThumbnail(const unsigned char* data, size_t size, const unsigned char*& thumbnail, size_t& length)
+    {
+        thumbnail = nullptr;
+        length = 0;
+        if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+
+        // 逐段查找 APP1(Exif)，遇到图像数据就停止
+        size_t pos = 2;
+        while (pos + 4 <= size) {
+            if (data[pos] != 0xFF) return false;
+            unsigned char marker = data[pos + 1];
+            if (marker == 0xFF) {
+                ++pos;
+                continue;
+            }
+            if (marker == 0xDA || marker == 0xD9) return false;
+            size_t segmentLength = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+            if (segmentLength < 2 || pos + 2 + segmentLength > size) return false;
+            const unsigned char* segment = data + pos + 4;
+            size_t segmentSize = segmentLength - 2;
+            if (marker == 0xE1 && segmentSize > 14 && std::memcmp(segment, "Exif\0\0", 6) == 0 &&
+                findTiffThumbnail(segment + 6, segmentSize - 6, thumbnail, length)) {
+                return true;
+            }
+            pos += 2 + segmentLength;
+        }
+        return false;
+    }
+
+private:
+    // tiff 为 TIFF 头开始的数据，IFD0 之后的下一个 IFD 即 IFD1
+    static bool findTiffThumbnail(const unsigned char* tiff, size_t size, const unsigned char*& thumbnail, size_t& length)
+    {
+        bool intel;
+        if (tiff[0] == 'I' && tiff[1] == 'I') intel = true;
+        else if (tiff[0] == 'M' && tiff[1] == 'M') intel = false;
+        else return false;
+        auto read16 = [&](size_t offset) -> uint32_t {
+            return intel ? (tiff[offset] | (tiff[offset + 1] << 8)) : ((tiff[offset] << 8) | tiff[offset + 1]);
+        };
+        auto read32 = [&](size_t offset) -> uint32_t {
+            return intel ? (read16(offset) | (read16(offset + 2) << 16)) : ((read16(offset) << 16) | read16(offset + 2));
+        };
+
+        size_t ifd0 = read32(4);
+        if (ifd0 + 2 > size) return false;
+        size_t next = ifd0 + 2 + static_cast<size_t>(read16(ifd0)) * 12;
+        if (next + 4 > size) return false;
+        size_t ifd1 = read32(next);
+        if (ifd1 == 0 || ifd1 + 2 > size) return false;
+
+        size_t offset = 0, bytes = 0;
+        uint32_t count = read16(ifd1);
+        for (uint32_t i = 0; i < count; ++i) {
+            size_t entry = ifd1 + 2 + static_cast<size_t>(i) * 12;
+            if (entry + 12 > size) break;
+            uint32_t tag = read16(entry);
+            uint32_t value = read16(entry + 2) == 3 ? read16(entry + 8) : read32(entry + 8); // SHORT 或 LONG
+            if (tag == 0x0201) offset = value;      // JPEGInterchangeFormat
+            else if (tag == 0x0202) bytes = value;  // JPEGInterchangeFormatLength
+        }
+        if (offset == 0 || bytes < 4 || offset + bytes > size) return false;
+        if (tiff[offset] != 0xFF || tiff[offset + 1] != 0xD8) return false;
+        thumbnail = tiff + offset;
+        length = bytes;
+        return true;
+    }
+
+public:
     
     // 添加有效性检查方法
     bool isValid() const { return m_isValid; }
@@ -26,8 +26,15 @@
 #define NANOVG_GL3_IMPLEMENTATION
 #include "nanovg_gl.h"
 #include "./utils/utils.h"
+#include "./component/TiledImage.h"
 #include "stb_image.h"
 
+namespace {
+// NanoVG 原来的纹理更新函数，以及当前接管上传的窗口
+int (*s_nvgUpdateTexture)(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data) = nullptr;
+PboUploader* s_pboUploader = nullptr;
+}
+
 
 /**
  * @brief UIWindow构造函数
@@ -134,6 +141,19 @@ bool UIWindow::initialize() {
         cleanup();
         return false;
     }
+
+    // 纹理更新（分段上传的大图、动画帧）改为经 PBO 上传，不在主线程等待传输
+    if (pboUploader.initialize()) {
+        NVGparams* params = nvgInternalParams(vg);
+        s_nvgUpdateTexture = params->renderUpdateTexture;
+        s_pboUploader = &pboUploader;
+        params->renderUpdateTexture = updateTextureWrapper;
+    }
+
+    // 超过显卡最大纹理尺寸的图片改为分块显示
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    TiledImage::setMaxTextureSize(maxTextureSize);
     
     // 添加字体加载代码
     int font = nvgCreateFont(vg, "default", "./msyh.ttc");
@@ -157,6 +177,22 @@ bool UIWindow::initialize() {
     return true;
 }
 
+/**
+ * @brief 纹理更新包装器
+ * @description 字体图集等单通道纹理和小块更新仍走 NanoVG 原来的实现
+ */
+int UIWindow::updateTextureWrapper(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data) {
+    GLNVGcontext* gl = static_cast<GLNVGcontext*>(uptr);
+    GLNVGtexture* tex = glnvg__findTexture(gl, image);
+    if (tex && tex->type == NVG_TEXTURE_RGBA && s_pboUploader &&
+        s_pboUploader->upload(tex->tex, tex->width, x, y, w, h, data)) {
+        // PBO 上传直接绑定了纹理，同步 NanoVG 记录的绑定状态
+        glnvg__bindTexture(gl, 0);
+        return 1;
+    }
+    return s_nvgUpdateTexture(uptr, image, x, y, w, h, data);
+}
+
 /**
  * @brief 清理所有分配的资源
  * @description 按相反顺序清理资源：NanoVG -> GLFW窗口 -> GLFW库
@@ -164,6 +200,11 @@ bool UIWindow::initialize() {
 void UIWindow::cleanup() {
     // 清理NanoVG上下文
     if (vg) {
+        if (s_pboUploader == &pboUploader) {
+            nvgInternalParams(vg)->renderUpdateTexture = s_nvgUpdateTexture;
+            s_pboUploader = nullptr;
+        }
+        pboUploader.release();
         nvgDeleteGL3(vg);
         vg = nullptr;
     }
@@ -10,6 +10,7 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "nanovg.h"
+#include "component/PboUploader.h"
 // 移除这行：#include "nanovg_gl.h"
 #include <functional>
 #include <string>
@@ -222,6 +223,9 @@ private:
     bool initialized;            ///< 初始化状态标志
     std::function<void(int, const char**)> dropCallback;
     static void dropCallbackWrapper(GLFWwindow* window, int count, const char** paths);
+    PboUploader pboUploader;     ///< 大块纹理更新经 PBO 异步上传
+    // 替换 NanoVG 后端的纹理更新，RGBA 大块更新交给 pboUploader
+    static int updateTextureWrapper(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data);
     
     // ==================== 回调函数存储 ====================
     
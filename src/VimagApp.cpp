@@ -21,9 +21,8 @@ VimagApp::VimagApp() : window(Config::DEFAULT_WINDOW_WIDTH, Config::DEFAULT_WIND
 
 VimagApp::~VimagApp() {
     // 等待后台线程完成
-    if (m_scanThread.joinable()) {
-        m_scanThread.join();
-    }
+    m_directoryScanner.stop();
+    m_metadataHarvester.stop();
 }
 
 bool VimagApp::initialize(int argc, char** argv) {
@@ -33,8 +32,7 @@ bool VimagApp::initialize(int argc, char** argv) {
     } else {
         std::cout << "Usage: " << argv[0] << " <file_path>" << std::endl;
         // 使用默认图像
-        imagePaths.push_back("Vimag.png");
-        imageNames.push_back("Vimag.png");
+        imageCatalog.addUtf8("Vimag.png");
     }
     
     // 初始化窗口
@@ -63,10 +61,18 @@ bool VimagApp::initialize(int argc, char** argv) {
     
     window.getFramebufferSize(currentWindowWidth, currentWindowHeight);
     
+    textureCaches = std::make_unique<TextureCaches>(window.getNVGContext());
+    textureCaches->setMemoryBudget(static_cast<size_t>(cacheMB) * 1024 * 1024);
+    // 后台预加载的纹理每帧最多占用四分之一帧时间上传，平移缩放保持目标帧率
+    textureCaches->setUploadBudget(1000.0 / Config::TARGET_FPS / 4);
+    updateDecodeFitSize();
+    
     createUI();
     
     setupEventHandlers();
     
+    prefetchNeighbors();
+    
     return true;
 }
 
@@ -77,32 +83,53 @@ void VimagApp::loadSettings() {
     showIndex = getSettingBool("Display", "image_index", true);
     showExif = getSettingBool("Display", "image_EXIF", true);
     enableExifOrientation = getSettingBool("Display", "Enable_Exif_orientation", true);
+    prefetchRadius = std::max(0, getSettingInt("Cache", "prefetch_count", 2));
+    cacheMB = std::max(0, getSettingInt("Cache", "cache_mb", 512));
+    zoomHeadroom = std::max(1.0f, getSettingFloat("Cache", "zoom_headroom", 1.5f));
+    directoryIndexEnabled = getSettingBool("Cache", "directory_index", true);
+    sortMode = ImageCatalog::sortModeFromName(getSetting("Display", "sort_mode", "path"));
+
+    // 磁盘预览缓存
+    PreviewCache::getInstance().configure(getSettingBool("Cache", "disk_cache", true),
+                                          getSetting("Cache", "disk_cache_dir", ""),
+                                          getSettingInt("Cache", "preview_size", 512),
+                                          static_cast<size_t>(std::max(0, getSettingInt("Cache", "disk_cache_mb", 2048))) * 1024 * 1024);
 }
 
 void VimagApp::loadImages(const std::string& filePath) {
     if (isFile(filePath)) {
         // 如果是文件，只加载这一个文件，延迟扫描目录
         fs::path directory = getDirectoryFromPath(filePath);
-        imagePaths.push_back(fs::path(filePath));
-        imageNames.push_back(fs::path(filePath).filename().string());
+        if (directory.empty()) directory = ".";
+        // 与扫描结果的路径写法一致，扫描到这个文件时不会重复加入
+        imageCatalog.add(directory / fs::path(filePath).filename());
         currentIndex = 0;
         
         // 标记需要后台扫描
         m_needsDirectoryScan = true;
         m_scanDirectory = directory;
-        m_originalFilePath = filePath;
     } else if (isDirectory(filePath)) {
-        fs::path directory = filePath;
-        find_image_files(directory, imagePaths, imageNames);
+        // 目录未变化时直接使用索引，结束后开始监视
+        m_scanDirectory = filePath;
+        m_directoryIndex.open(m_scanDirectory, directoryIndexEnabled);
+        m_directoryIndex.beginScan();
+        DirectoryScanner::scan(m_scanDirectory, imageCatalog, &m_directoryIndex);
+        imageCatalog.sort(sortMode);
+        m_directoryIndex.finishScan();
+        m_directoryIndex.save();
     } else {
         // 原有的默认处理逻辑
         fs::path directory = "./";
-        getImages(filePath, directory, imagePaths, imageNames, currentIndex);
+        std::vector<fs::path> paths;
+        std::vector<std::string> names;
+        getImages(filePath, directory, paths, names, currentIndex);
+        for (const auto& path : paths) {
+            imageCatalog.add(path);
+        }
     }
     
-    if (imagePaths.empty()) {
-        imagePaths.push_back("Vimag.png");
-        imageNames.push_back("Vimag.png");
+    if (imageCatalog.empty()) {
+        imageCatalog.addUtf8("Vimag.png");
         currentIndex = 0;
     }
 }
@@ -121,7 +148,11 @@ void VimagApp::run() {
     
     // 启动后台目录扫描
     if (m_needsDirectoryScan) {
+        m_directoryIndex.open(m_scanDirectory, directoryIndexEnabled);
         startBackgroundDirectoryScan();
+    } else {
+        startDirectoryWatch();
+        startMetadataHarvest(true);
     }
 
     while (!window.shouldClose()) {
@@ -157,6 +188,13 @@ void VimagApp::run() {
         
         // 检查后台扫描是否完成
         checkBackgroundScanCompletion();
+        applyDirectoryChanges();
+        applyHarvestedMetadata();
+
+        // 上传后台解码完成的纹理，并显示等待中的图片
+        textureCaches->processMainThreadTasks();
+        checkPendingImageLoad();
+        checkCachedTextureUpdate();
 
         
         // === 优化渲染条件 ===
@@ -207,45 +245,429 @@ void VimagApp::run() {
     }
     
     // 清理后台线程
-    if (m_scanThread.joinable()) {
-        m_scanThread.join();
-    }
+    m_directoryScanner.stop();
+    m_directoryWatcher.stop();
+    m_metadataHarvester.stop();
+    m_directoryIndex.save();
+    // 在 NanoVG 上下文销毁前释放缓存纹理
+    textureCaches.reset();
 }
 
 // 添加后台扫描方法的实现
 void VimagApp::startBackgroundDirectoryScan() {
-    m_scanThread = std::thread([this]() {
-        std::vector<fs::path> allImagePaths;
-        std::vector<std::string> allImageNames;
-        
-        // 在后台线程中扫描目录
-        find_image_files(m_scanDirectory, allImagePaths, allImageNames);
-        
-        // 找到原始文件的索引
-        size_t newIndex = findPathIndex(allImagePaths, m_originalFilePath);
-        
-        // 原子性地更新主线程数据
-        {
+    // 扫描线程按批次交回结果，主线程每帧并入列表，扫描完成前即可切换图片
+    m_directoryIndex.beginScan();
+    bool started = m_directoryScanner.start(m_scanDirectory,
+        [this](DirectoryScanner::Batch& batch) {
             std::lock_guard<std::mutex> lock(m_imageDataMutex);
-            imagePaths = std::move(allImagePaths);
-            imageNames = std::move(allImageNames);
-            if (newIndex != static_cast<size_t>(-1)) {
-                currentIndex = newIndex;
-            }
-        }
-        
-        m_scanCompleted = true;
-    });
+            m_scannedImages.append(batch);
+        },
+        [this]() {
+            m_directoryIndex.finishScan();
+            m_directoryIndex.save();
+            m_scanCompleted = true;
+        },
+        &m_directoryIndex);
+    if (!started) {
+        m_needsDirectoryScan = false;
+    }
 }
 
 void VimagApp::checkBackgroundScanCompletion() {
-    if (m_scanCompleted.load()) {
-        {
-            std::lock_guard<std::mutex> lock(m_imageDataMutex);
-            updateImageLabels(); // 更新显示的图片信息
+    if (!m_needsDirectoryScan) return;
+
+    // 先读完成标记再取结果，完成时最后一批一定已经交来
+    bool completed = m_scanCompleted.load();
+    ImageCatalog batch;
+    {
+        std::lock_guard<std::mutex> lock(m_imageDataMutex);
+        std::swap(batch, m_scannedImages);
+    }
+
+    if (m_replaceOnScanCompletion) {
+        // 重新扫描期间继续浏览原列表，完成后整体替换
+        m_rescannedImages.append(batch);
+        if (!completed) return;
+
+        fs::path currentPath = imageCatalog.path(currentIndex);
+        imageCatalog = std::move(m_rescannedImages);
+        m_rescannedImages = ImageCatalog();
+        imageCatalog.sort(sortMode);
+        m_replaceOnScanCompletion = false;
+        m_scanCompleted = false;
+        m_needsDirectoryScan = false;
+        if (restoreCurrentIndex(currentPath)) {
+            updateImageLabels();
+            prefetchNeighbors();
+        } else {
+            updateImageDisplay();
         }
+        startDirectoryWatch();
+        startMetadataHarvest(true);
+        return;
+    }
+
+    // 新图片追加在末尾，当前图片的序号不变
+    // 启动时打开的文件已经在列表中，合并时跳过
+    size_t previousCount = imageCatalog.size();
+    imageCatalog.append(batch);
+
+    if (completed) {
+        // 扫描完成后排序，当前显示的图片保持不变
+        fs::path currentPath = imageCatalog.path(currentIndex);
+        imageCatalog.sort(sortMode);
+        restoreCurrentIndex(currentPath);
+        std::cout << "[Scan] " << imageCatalog.size() << " images in " << m_scanDirectory << std::endl;
+
         m_scanCompleted = false;
         m_needsDirectoryScan = false;
+        updateImageLabels();
+        prefetchNeighbors();
+        startDirectoryWatch();
+        startMetadataHarvest(true);
+    } else if (imageCatalog.size() != previousCount) {
+        updateImageLabels();
+        // 前方的相邻图片刚出现时补充预加载
+        if (previousCount <= currentIndex + prefetchRadius) {
+            prefetchNeighbors();
+        }
+    }
+}
+
+void VimagApp::startDirectoryWatch() {
+    if (m_scanDirectory.empty() || !m_directoryWatcher.start()) return;
+    size_t watched = 0;
+    for (const auto& directory : m_directoryIndex.getDirectories()) {
+        if (m_directoryWatcher.watch(directory)) {
+            ++watched;
+        }
+    }
+    std::cout << "[DirectoryWatcher] Watching " << watched << " directories in " << m_scanDirectory << std::endl;
+}
+
+void VimagApp::applyDirectoryChanges() {
+    if (m_needsDirectoryScan || !m_directoryWatcher.isActive()) return;
+    std::vector<DirectoryWatcher::Change> changes;
+    m_directoryWatcher.poll(changes);
+    if (changes.empty()) return;
+
+    fs::path currentPath = imageCatalog.path(currentIndex);
+    bool reloadCurrent = false;
+    for (const auto& change : changes) {
+        switch (change.type) {
+            case DirectoryWatcher::Change::Added:
+                if (insertImage(change.path) && change.path == currentPath) {
+                    reloadCurrent = true;
+                }
+                break;
+            case DirectoryWatcher::Change::Removed:
+                removeImage(change.path);
+                break;
+            case DirectoryWatcher::Change::DirectoryRemoved:
+                removeDirectoryImages(change.path);
+                break;
+            case DirectoryWatcher::Change::Overflow:
+                // 有事件丢失，无法就地更新，后台重新扫描（未变化的目录直接使用索引）
+                std::cerr << "[DirectoryWatcher] Event queue overflowed, rescanning " << m_scanDirectory << std::endl;
+                m_directoryWatcher.stop();
+                m_metadataHarvester.stop();
+                m_harvestActive = false;
+                m_replaceOnScanCompletion = true;
+                m_needsDirectoryScan = true;
+                startBackgroundDirectoryScan();
+                return;
+        }
+        // 所在目录的记录已过期，下次打开时重新列出
+        m_directoryIndex.invalidate(change.path.parent_path());
+    }
+
+    if (restoreCurrentIndex(currentPath) && !reloadCurrent) {
+        updateImageLabels();
+        prefetchNeighbors();
+    } else {
+        // 当前图片被删除时显示原位置上的下一张，被改写时重新加载
+        updateImageDisplay();
+    }
+}
+
+bool VimagApp::insertImage(const fs::path& path) {
+    // 读取一次大小和修改时间
+    std::error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) size = 0;
+    int64_t modified = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    if (ec) modified = 0;
+
+    size_t index = imageCatalog.find(path);
+    if (index == ImageCatalog::npos) {
+        // 新文件按当前排序方式插入
+        imageCatalog.insertSorted(path, size, modified);
+        m_harvestPending = true;
+        return false;
+    }
+    // 已在列表中：重复报告，或被原地改写（联机拍摄、编辑器保存）
+    if (imageCatalog.fileSize(index) == size && imageCatalog.modifiedTime(index) == modified) return false;
+    imageCatalog.setFileInfo(index, size, modified);
+    imageCatalog.setDimensions(index, 0, 0);
+    imageCatalog.setOrientation(index, ImageCatalog::UNKNOWN_ORIENTATION);
+    m_harvestPending = true;
+    if (m_indexedDimensionsPath == path) {
+        m_indexedDimensionsPath.clear();
+    }
+    // 正在显示的纹理可能来自缓存，先卸载再淘汰缓存中的旧纹理
+    if (texture->getImagePath() == path.generic_string()) {
+        texture->setImagePath(window.getNVGContext(), "");
+    }
+    if (textureCaches) {
+        textureCaches->removeImageCacheData(path);
+    }
+    // 信息面板缓存的是旧文件的元数据
+    if (metadataPath == path.generic_string()) {
+        metadataPath.clear();
+    }
+    return true;
+}
+
+void VimagApp::startMetadataHarvest(bool verifyKnown) {
+    m_harvestPending = false;
+    m_harvestChangedFiles = false;
+    std::vector<MetadataHarvester::Request> requests;
+    size_t count = imageCatalog.size();
+    auto addRequest = [&](size_t index) {
+        bool known = imageCatalog.hasHeaderInfo(index);
+        if (known && !verifyKnown) return;
+        requests.push_back({std::string(imageCatalog.pathView(index)), imageCatalog.fileSize(index),
+                            imageCatalog.modifiedTime(index), known});
+    };
+    // 当前图片附近的先读，浏览时最先用到
+    for (size_t offset = 0; offset < count; ++offset) {
+        if (currentIndex + offset < count) {
+            addRequest(currentIndex + offset);
+        }
+        if (offset > 0 && offset <= currentIndex) {
+            addRequest(currentIndex - offset);
+        }
+    }
+    if (requests.empty()) return;
+    m_metadataHarvester.start(std::move(requests));
+    m_harvestActive = true;
+}
+
+void VimagApp::applyHarvestedMetadata() {
+    if (!m_harvestActive) {
+        if (m_harvestPending && !m_needsDirectoryScan) {
+            // 只读取新加入的图片
+            startMetadataHarvest(false);
+        }
+        return;
+    }
+    // 先读运行标记再取结果，线程结束时最后一批一定已经交来
+    bool finished = !m_metadataHarvester.isRunning();
+    std::vector<MetadataHarvester::Result> results;
+    m_metadataHarvester.poll(results);
+
+    for (const auto& result : results) {
+        size_t index = imageCatalog.findUtf8(result.path);
+        if (index == ImageCatalog::npos) continue; // 读取期间已被删除
+        // 读取之后文件又被改写过（目录监视已更新记录），等下一次读取
+        if (result.modified < imageCatalog.modifiedTime(index)) continue;
+        // 无法识别的文件也记为已读取，文件不变时不再重复读取
+        const ImageHeaderInfo& info = result.info;
+        if (imageCatalog.fileSize(index) != result.size || imageCatalog.modifiedTime(index) != result.modified) {
+            // 索引中的记录已过期（原地改写），原有尺寸作废
+            imageCatalog.setFileInfo(index, result.size, result.modified);
+            imageCatalog.setDimensions(index, 0, 0);
+            m_harvestChangedFiles = true;
+            if (metadataPath == imageCatalog.path(index).generic_string()) {
+                metadataPath.clear();
+            }
+        }
+        if (info.width > 0 && info.height > 0) {
+            imageCatalog.setDimensions(index, info.width, info.height);
+        }
+        imageCatalog.setOrientation(index, info.orientation);
+        imageCatalog.setCaptureTime(index, info.captureTime);
+        if (info.format != ImageFormat::Unknown) {
+            imageCatalog.setFormat(index, info.format);
+        }
+        m_directoryIndex.setHeaderInfo(fs::u8path(result.path), result.size, result.modified,
+                                       info.width, info.height, info.orientation, info.captureTime);
+    }
+    if (!finished) return;
+
+    m_harvestActive = false;
+    // 按刚读到的元数据排序时重新排序，当前图片保持不变
+    bool fileInfoSort = sortMode == ImageCatalog::SortMode::Modified || sortMode == ImageCatalog::SortMode::FileSize;
+    bool changedFiles = m_harvestChangedFiles;
+    m_harvestChangedFiles = false;
+    if (sortMode == ImageCatalog::SortMode::CaptureTime || sortMode == ImageCatalog::SortMode::Dimensions ||
+        (fileInfoSort && changedFiles)) {
+        fs::path currentPath = imageCatalog.path(currentIndex);
+        imageCatalog.sort(sortMode);
+        restoreCurrentIndex(currentPath);
+        updateImageLabels();
+        prefetchNeighbors();
+    }
+}
+
+void VimagApp::removeImage(const fs::path& path) {
+    imageCatalog.erase(path);
+}
+
+void VimagApp::removeDirectoryImages(const fs::path& directory) {
+    imageCatalog.eraseDirectory(directory);
+}
+
+bool VimagApp::restoreCurrentIndex(const fs::path& currentPath) {
+    if (imageCatalog.empty()) {
+        imageCatalog.addUtf8("Vimag.png");
+    }
+    size_t index = imageCatalog.find(currentPath);
+    bool found = index != ImageCatalog::npos;
+    if (!found) {
+        // 按路径排序时停在原图片所在的位置，其他排序方式下停在原序号
+        index = imageCatalog.sortMode() == ImageCatalog::SortMode::Path ? imageCatalog.lowerBound(currentPath)
+                                                                          : currentIndex;
+    }
+    currentIndex = std::min(index, imageCatalog.size() - 1);
+    // 等待显示的总是当前图片
+    if (hasPendingImageLoad) {
+        pendingImageIndex = currentIndex;
+    }
+    return found;
+}
+
+void VimagApp::prefetchNeighbors() {
+    if (!textureCaches || imageCatalog.empty()) return;
+
+    // 当前图片优先（纹理控件已自行加载时除外），其余按距离由近到远排列，同距离时沿浏览方向的先解码
+    std::vector<fs::path> requests;
+    if (texture->getImagePath() != imageCatalog.path(currentIndex).generic_string()) {
+        requests.push_back(imageCatalog.path(currentIndex));
+    }
+    const long count = static_cast<long>(imageCatalog.size());
+    for (int offset = 1; offset <= prefetchRadius && offset < count; ++offset) {
+        for (int sign : {lastDirection, -lastDirection}) {
+            long index = static_cast<long>(currentIndex) + sign * offset;
+            if (imageCycle) {
+                index = ((index % count) + count) % count;
+            } else if (index < 0 || index >= count) {
+                continue;
+            }
+            if (index != static_cast<long>(currentIndex) &&
+                std::find(requests.begin(), requests.end(), imageCatalog.path(index)) == requests.end()) {
+                requests.push_back(imageCatalog.path(index));
+            }
+        }
+    }
+
+    // 新一批请求之外的解码全部取消
+    textureCaches->beginGeneration();
+    textureCaches->preloadImages(requests, imageCatalog.path(currentIndex));
+
+    // 当前、相邻以及正在显示的纹理不参与显存预算淘汰
+    std::vector<fs::path> pinnedPaths{imageCatalog.path(currentIndex), fs::path(texture->getImagePath())};
+    for (long offset : {-1L, 1L}) {
+        long index = static_cast<long>(currentIndex) + offset;
+        if (imageCycle) {
+            index = ((index % count) + count) % count;
+        } else if (index < 0 || index >= count) {
+            continue;
+        }
+        pinnedPaths.push_back(imageCatalog.path(index));
+    }
+    textureCaches->setPinnedImages(pinnedPaths);
+}
+
+bool VimagApp::showCachedImage(const fs::path& path) {
+    int width = 0, height = 0, frameCount = 0;
+    std::vector<int> imageId;
+    std::vector<TextureLevel> levels;
+    std::shared_ptr<TiledImage> tiled;
+    if (!textureCaches || !textureCaches->getImageCacheData(path, width, height, frameCount, imageId, &levels, &tiled) || imageId.empty()) {
+        return false;
+    }
+    texture->setCachedImage(window.getNVGContext(), path.generic_string(), imageId[0], width, height, levels, tiled);
+    return true;
+}
+
+void VimagApp::checkPendingImageLoad() {
+    if (!hasPendingImageLoad) return;
+    if (pendingImageIndex != currentIndex || pendingImageIndex >= imageCatalog.size()) {
+        hasPendingImageLoad = false;
+        return;
+    }
+
+    fs::path path = imageCatalog.path(pendingImageIndex);
+    if (showCachedImage(path)) {
+        hasPendingImageLoad = false;
+    } else if (!textureCaches->isImageLoading(path)) {
+        // 后台解码失败，回退到同步加载以显示错误信息
+        hasPendingImageLoad = false;
+        texture->setImagePath(window.getNVGContext(), path.generic_string());
+    } else {
+        return;
+    }
+    updateWindowSize();
+    updateImageLabels();
+}
+
+void VimagApp::updateDecodeFitSize() {
+    if (!textureCaches) return;
+    textureCaches->setFitSize(static_cast<int>(currentWindowWidth * zoomHeadroom),
+                              static_cast<int>(currentWindowHeight * zoomHeadroom));
+}
+
+void VimagApp::ensureImageResolution() {
+    if (!textureCaches || hasPendingImageLoad || imageCatalog.empty()) return;
+    fs::path path = imageCatalog.path(currentIndex);
+    if (texture->getImagePath() != path.generic_string()) return;
+
+    // 同步加载的纹理本身就是原图，不在缓存中
+    int textureWidth = 0, textureHeight = 0;
+    bool fullResolution = true;
+    if (!textureCaches->getTextureResolution(path, textureWidth, textureHeight, fullResolution) || fullResolution) {
+        return;
+    }
+
+    float imageWidth = static_cast<float>(texture->getImageWidth());
+    float imageHeight = static_cast<float>(texture->getImageHeight());
+    if (imageWidth <= 0 || imageHeight <= 0) return;
+    float fitScale = std::min(texture->getOriginWidth() / imageWidth, texture->getOriginHeight() / imageHeight);
+    float displayWidth = imageWidth * fitScale * scaleX;
+    if (displayWidth > textureWidth && !waitingFullResolution) {
+        waitingFullResolution = textureCaches->requestFullResolution(path);
+        fullResolutionRetries = 0;
+    }
+}
+
+void VimagApp::checkCachedTextureUpdate() {
+    if (hasPendingImageLoad || imageCatalog.empty() || !texture->isCachedImage()) {
+        waitingFullResolution = false;
+        return;
+    }
+
+    fs::path path = imageCatalog.path(currentIndex);
+    int textureWidth = 0, textureHeight = 0;
+    bool fullResolution = false;
+    if (texture->getImagePath() != path.generic_string() ||
+        !textureCaches->getTextureResolution(path, textureWidth, textureHeight, fullResolution)) {
+        waitingFullResolution = false;
+        return;
+    }
+
+    // 旧纹理已在上传新纹理时释放，必须在本帧绘制前切换；只替换纹理，保持当前缩放和位置
+    int image = textureCaches->getImageTexture(path);
+    if (image != -1 && image != texture->getImageHandle()) {
+        showCachedImage(path);
+    }
+
+    if (!waitingFullResolution) return;
+    if (fullResolution) {
+        waitingFullResolution = false;
+    } else if (!textureCaches->isImageLoading(path)) {
+        // 请求被线程池丢弃，或完整解码只得到缩小的纹理，重新提交；解码失败时不再重试
+        waitingFullResolution = fullResolutionRetries++ < 2 && textureCaches->requestFullResolution(path);
     }
 }
 
@@ -273,7 +695,7 @@ void VimagApp::createImagePanel() {
     rightPanel->setBackgroundColor(Config::BGCOLOR);
     
     // 创建纹理组件
-    std::string imagePath = imagePaths[currentIndex].generic_string();
+    std::string imagePath = imageCatalog.path(currentIndex).generic_string();
     texture = std::make_shared<UITexture>(0, 0, 
         currentWindowWidth * Config::IMAGE_SCALE_RATIO, 
         currentWindowHeight * Config::IMAGE_SCALE_RATIO, 
@@ -287,6 +709,13 @@ void VimagApp::createImagePanel() {
     mainPanel->addChild(rightPanel);
 }
 
+namespace {
+// 与 ImageCatalog::SortMode 的顺序一致
+const char* const SORT_BUTTON_TEXT[ImageCatalog::SORT_MODE_COUNT] = {
+    "Sort by path", "Sort by name", "Sort by date modified", "Sort by date taken", "Sort by size", "Sort by dimensions"
+};
+}
+
 void VimagApp::createSettingPanel() {
     settingPanel = std::make_shared<UIPanel>(0, 0, 500, 480);
     settingPanel->setVerticalLayoutWithAlignment(FlexLayout::X_START, FlexLayout::Y_CENTER, 10.0f, 10.0f);
@@ -353,9 +782,20 @@ void VimagApp::createSettingPanel() {
     imageCycleButton->setOnClick([this]() {
         handleCycleButtonClick(imageCycleButton);  // 如果这里也要使用相同的逻辑
     });
+    sortButton = std::make_shared<UIButton>(0, 0, 200, 50, SORT_BUTTON_TEXT[static_cast<int>(sortMode)]);
+    sortButton->setTextColor(nvgRGBA(0, 0, 0, 255));
+    sortButton->setFontSize(18.0f);
+    sortButton->setCornerRadius(25.0f);
+    sortButton->setHoverColor(HoverColor);
+    sortButton->setFocusColor(FocusColor);
+    sortButton->setPressedColor(PressedColor);
+    sortButton->setOnClick([this]() {
+        handleSortButtonClick(sortButton);
+    });
     settingPanel->addChild(indexButton);
     settingPanel->addChild(showExifInfo);
     settingPanel->addChild(imageCycleButton);
+    settingPanel->addChild(sortButton);
     mainPanel->addChild(settingPanel);
 }
 
@@ -376,19 +816,33 @@ void VimagApp::createLabels() {
 
 void VimagApp::handleImageChange(int direction) {
     currentIndex += direction;
+    if (direction != 0) {
+        lastDirection = direction > 0 ? 1 : -1;
+    }
     
     // 修复参数传递 - enableImageCycle 需要引用参数
-    size_t limitIndex = imagePaths.size();
+    size_t limitIndex = imageCatalog.size();
     // bool imageCycle = true; // 从配置读取
     enableImageCycle(currentIndex, limitIndex, imageCycle);
     
+    // updateImageDisplay 已更新标签
     updateImageDisplay();
-    updateImageLabels();
 }
 
 void VimagApp::updateImageDisplay() {
-    std::string imagePath = imagePaths[currentIndex].generic_string();
-    texture->setImagePath(window.getNVGContext(), imagePath);
+    fs::path path = imageCatalog.path(currentIndex);
+    hasPendingImageLoad = false;
+    // 当前图片以最高优先级进入解码队列，并取消已经过时的请求
+    prefetchNeighbors();
+    if (!showCachedImage(path)) {
+        if (textureCaches && textureCaches->isImageLoading(path)) {
+            // 后台解码完成后再显示，渲染线程不再阻塞
+            hasPendingImageLoad = true;
+            pendingImageIndex = currentIndex;
+        } else {
+            texture->setImagePath(window.getNVGContext(), path.generic_string());
+        }
+    }
     
     updateWindowSize();
     updateImageLabels();
@@ -397,8 +851,8 @@ void VimagApp::updateImageDisplay() {
 void VimagApp::updateImageLabels() {
     std::string label_info="";
     std::string indexString = "[" + std::to_string(currentIndex + 1) + "/" + 
-                             std::to_string(imagePaths.size()) + "]";
-    std::string imageName = imageNames[currentIndex];
+                             std::to_string(imageCatalog.size()) + "]";
+    std::string imageName = imageCatalog.name(currentIndex);
     
     if (texture->isLoadError()) {
         texture -> setImagePath(window.getNVGContext(),"./imageFail.gif");
@@ -410,8 +864,19 @@ void VimagApp::updateImageLabels() {
         }else{
             label_info = indexString +" ● " + imageName + " ● " + std::to_string(texture->getImageWidth()) + "x" + std::to_string(texture->getImageHeight());
         }
-        std::string exif_info;
-        bool ExifInfo_S = getExifInfo(imagePaths[currentIndex].generic_string(), exif_info,textureOrientation);
+        // 已知的尺寸记入列表和目录索引
+        fs::path currentPath = imageCatalog.path(currentIndex);
+        if (currentPath != m_indexedDimensionsPath && texture->getImageWidth() > 0 &&
+            texture->getImagePath() == currentPath.generic_string()) {
+            m_indexedDimensionsPath = currentPath;
+            imageCatalog.setDimensions(currentIndex, texture->getImageWidth(), texture->getImageHeight());
+            m_directoryIndex.setDimensions(currentPath, texture->getImageWidth(), texture->getImageHeight());
+        }
+        // 元数据在解码时一并解析并随纹理缓存，这里不再读取文件
+        const ImageMetadata& metadata = getCurrentMetadata();
+        std::string exif_info = metadata.exifSummary;
+        bool ExifInfo_S = metadata.exifValid;
+        textureOrientation = metadata.orientation;
         
         if(enableExifOrientation){
             if (ExifInfo_S) {
@@ -520,6 +985,32 @@ void VimagApp::handleCycleButtonClick(std::shared_ptr<UIButton> btn){
     saveSetting();
 
 }
+void VimagApp::handleSortButtonClick(std::shared_ptr<UIButton> btn) {
+    UIAnimationManager::getInstance().fadeOut(btn.get(), Config::ANIMATION_DURATION, UIAnimation::EASE_IN);
+    cycleSortMode();
+}
+
+void VimagApp::cycleSortMode() {
+    int next = (static_cast<int>(sortMode) + 1) % ImageCatalog::SORT_MODE_COUNT;
+    sortMode = static_cast<ImageCatalog::SortMode>(next);
+    if (sortButton) {
+        sortButton->setText(SORT_BUTTON_TEXT[next]);
+    }
+    setSetting("Display", "sort_mode", ImageCatalog::sortModeName(sortMode));
+    saveSetting();
+
+    // 只使用列表中已有的元数据，不读取文件；当前图片保持不变，序号随新位置更新
+    fs::path currentPath = imageCatalog.path(currentIndex);
+    auto start = std::chrono::steady_clock::now();
+    imageCatalog.sort(sortMode);
+    restoreCurrentIndex(currentPath);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Sort] " << ImageCatalog::sortModeName(sortMode) << ", " << imageCatalog.size()
+              << " images in " << elapsed << " ms" << std::endl;
+    updateImageLabels();
+    prefetchNeighbors();
+}
+
 void VimagApp::setupEventHandlers() {
     // 窗口大小变化回调
     window.setWindowSizeCallback([this](int width, int height) {
@@ -527,6 +1018,8 @@ void VimagApp::setupEventHandlers() {
         currentWindowHeight = height;
         updateWindowSize();
         mainPanel->updateLayout();
+        updateDecodeFitSize();
+        ensureImageResolution();
     });
     
     // 纹理事件处理
@@ -691,6 +1184,10 @@ void VimagApp::setupWindowEvents() {
                 handleFullscreenToggle();
                 return;
             }
+            else if (key == GLFW_KEY_S && action == GLFW_PRESS) {
+                cycleSortMode();
+                return;
+            }
             
             // 执行图片切换
             if (direction != 0) {
@@ -762,6 +1259,7 @@ void VimagApp::handleImageScale(float scrollY) {
     
     // 立即标记需要重绘
     texture->setPaintValid(false);
+    ensureImageResolution();
 }
 
 void VimagApp::resetImageTransform() {
@@ -796,6 +1294,8 @@ void VimagApp::handleFullscreenToggle() {
     window.toggleFullscreen();
     window.getFramebufferSize(currentWindowWidth, currentWindowHeight);
     updateWindowSize();
+    updateDecodeFitSize();
+    ensureImageResolution();
 }
 
 void VimagApp::handleSettingToggle() {
@@ -854,6 +1354,24 @@ void VimagApp::handleSettingToggle() {
     std::cout << "targetPositionX: " << targetX << " targetPositionY: " << targetY << std::endl;
 }
 
+const ImageMetadata& VimagApp::getCurrentMetadata() {
+    static const ImageMetadata pendingMetadata;
+    // 等待后台解码时不单独解析，解码完成后随纹理一起得到
+    if (hasPendingImageLoad) return pendingMetadata;
+
+    std::string path = imageCatalog.path(currentIndex).generic_string();
+    if (metadataPath == path) return currentMetadata;
+
+    if (texture->getImagePath() == path && texture->isImageLoaded() && !texture->isCachedImage()) {
+        currentMetadata = texture->getMetadata();
+    } else if (!textureCaches || !textureCaches->getImageMetadata(imageCatalog.path(currentIndex), currentMetadata)) {
+        // 占位图也尚未上传，不在渲染线程读取文件，下一帧再查询
+        return pendingMetadata;
+    }
+    metadataPath = path;
+    return currentMetadata;
+}
+
 std::string VimagApp::getImageInfo() const {
     // 实现获取图像信息逻辑
     return "";
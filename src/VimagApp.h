@@ -5,7 +5,14 @@
 #include "component/UILabel.h"
 #include "component/UITexture.h"
 #include "component/FlexLayout.h"
+#include "component/TextureCacheData.h"
 #include "utils/utils.h"
+#include "utils/ImageCatalog.h"
+#include "utils/DirectoryScanner.h"
+#include "utils/DirectoryIndex.h"
+#include "utils/DirectoryWatcher.h"
+#include "utils/MetadataHarvester.h"
+#include "utils/PreviewCache.h"
 #include <nanovg.h>
 #include <memory>
 #include <vector>
@@ -44,10 +51,11 @@ private:
     std::shared_ptr<UIButton> indexButton;
     std::shared_ptr<UIButton> imageCycleButton;
     std::shared_ptr<UIButton> showExifInfo;
+    std::shared_ptr<UIButton> sortButton;
+    std::unique_ptr<TextureCaches> textureCaches; // 相邻图片后台预加载
 
     // 应用状态
-    std::vector<fs::path> imagePaths;
-    std::vector<std::string> imageNames;
+    ImageCatalog imageCatalog; // 图片路径和元数据，按路径排序
     size_t currentIndex = 0;
     int currentWindowWidth, currentWindowHeight;
     
@@ -56,6 +64,7 @@ private:
     float totalDeltaY = 0.0f;
     float scaleX = 1.0f, scaleY = 1.0f;
     int changeSpeed = 0;
+    int lastDirection = 1; // 最近一次切换方向，预加载时优先该方向
     
     // 添加鼠标状态跟踪变量
     bool isLeftMousePressed = false;
@@ -73,16 +82,35 @@ private:
     bool showIndex = true;
     bool showExif = true;
     bool enableExifOrientation = true;
+    int prefetchRadius = 2; // 当前图片前后各预加载的数量
+    int cacheMB = 512;      // 纹理缓存显存预算（MB）
+    float zoomHeadroom = 1.5f; // 预加载按窗口尺寸乘以该系数缩小解码
+    bool directoryIndexEnabled = true; // 目录索引保存到缓存目录，再次打开时只检查变化的目录
+    ImageCatalog::SortMode sortMode = ImageCatalog::SortMode::Path;
+    bool waitingFullResolution = false; // 放大后等待原图纹理
+    int fullResolutionRetries = 0;
 
     // 添加后台扫描相关成员变量
     bool m_needsDirectoryScan = false;
     fs::path m_scanDirectory;
-    std::string m_originalFilePath;
-    std::thread m_scanThread;
+    bool m_replaceOnScanCompletion = false; // 监视事件丢失后重新扫描，完成时整体替换列表
+    ImageCatalog m_rescannedImages;
     std::mutex m_imageDataMutex;
+    ImageCatalog m_scannedImages; // 扫描线程交来、尚未并入列表的图片（m_imageDataMutex 保护）
     std::atomic<bool> m_scanCompleted{false};
+    DirectoryIndex m_directoryIndex;
+    DirectoryScanner m_directoryScanner;
+    DirectoryWatcher m_directoryWatcher;
+    MetadataHarvester m_metadataHarvester;
+    bool m_harvestActive = false;   // 已启动、结果尚未全部取回
+    bool m_harvestPending = false;  // 读取期间又有新图片加入，结束后再读取一次
+    bool m_harvestChangedFiles = false; // 本次读取发现原地改写过的文件
+    fs::path m_indexedDimensionsPath; // 最近一次记入索引尺寸的图片
 
     int textureOrientation = 0;
+    // 当前图片的元数据，按路径缓存，定时刷新标签时不再重复解析
+    ImageMetadata currentMetadata;
+    std::string metadataPath;
 
 public:
     VimagApp();
@@ -113,6 +141,9 @@ private:
     void handleIndexButtonClick(std::shared_ptr<UIButton> btn);
     void handleExifButtonClick(std::shared_ptr<UIButton> btn);
     void handleCycleButtonClick(std::shared_ptr<UIButton> btn);
+    void handleSortButtonClick(std::shared_ptr<UIButton> btn);
+    // 切换到下一种排序方式（S 键）
+    void cycleSortMode();
     
     // 事件设置方法
     void setupTextureEvents();
@@ -125,10 +156,36 @@ private:
     // 工具方法
     std::string getImageInfo() const;
     void updateImageLabels();
+    const ImageMetadata& getCurrentMetadata();
     
     // 添加后台扫描相关方法声明
     void startBackgroundDirectoryScan();
+    // 并入扫描线程交来的图片，扫描完成后排序
     void checkBackgroundScanCompletion();
+    // 监视目录变化，增删图片时按当前排序方式就地更新列表
+    void startDirectoryWatch();
+    void applyDirectoryChanges();
+    // 已在列表中的图片被改写时刷新记录并淘汰旧纹理，返回 true
+    bool insertImage(const fs::path& path);
+    void removeImage(const fs::path& path);
+    void removeDirectoryImages(const fs::path& directory);
+    // 列表变化后按路径找回当前图片，图片已不在时返回 false（序号停在原位置附近）
+    bool restoreCurrentIndex(const fs::path& currentPath);
+    // 后台读取列表中尚无文件头信息的图片，从当前图片向两侧展开
+    // verifyKnown：已有信息的图片也检查大小和修改时间，改写过的重新读取
+    void startMetadataHarvest(bool verifyKnown);
+    // 把读取结果写入列表和目录索引，全部完成后按拍摄时间或尺寸排序时重新排序
+    void applyHarvestedMetadata();
+
+    // 相邻图片预加载
+    void prefetchNeighbors();
+    bool showCachedImage(const fs::path& path);
+    void checkPendingImageLoad();
+    // 按显示尺寸缩小解码，放大超过纹理分辨率时加载原图
+    void updateDecodeFitSize();
+    void ensureImageResolution();
+    // 缓存中的纹理被替换（预览图换成完整解码、缩小的纹理升级为原图）时切换显示
+    void checkCachedTextureUpdate();
     
 
 
@@ -0,0 +1,76 @@
+#include "PboUploader.h"
+#include <cstring>
+#include <iostream>
+
+PboUploader::~PboUploader() {
+    release();
+}
+
+bool PboUploader::initialize() {
+    if (m_initialized) return true;
+    // glMapBufferRange 需要 OpenGL 3.0
+    if (!GLEW_VERSION_3_0) {
+        std::cerr << "[PboUploader] OpenGL 3.0 not available, using synchronous uploads" << std::endl;
+        return false;
+    }
+    glGenBuffers(BUFFER_COUNT, m_buffers);
+    m_initialized = true;
+    std::cout << "[PboUploader] Streaming texture uploads through " << BUFFER_COUNT << " pixel buffers" << std::endl;
+    return true;
+}
+
+void PboUploader::release() {
+    if (!m_initialized) return;
+    glDeleteBuffers(BUFFER_COUNT, m_buffers);
+    for (int i = 0; i < BUFFER_COUNT; ++i) {
+        m_buffers[i] = 0;
+        m_sizes[i] = 0;
+    }
+    m_initialized = false;
+}
+
+bool PboUploader::upload(GLuint texture, int textureWidth, int x, int y, int width, int height, const unsigned char* data) {
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    size_t size = rowBytes * height;
+    if (!m_initialized || !data || width <= 0 || height <= 0 || size < MIN_UPLOAD_BYTES) {
+        return false;
+    }
+
+    int index = m_next;
+    m_next = (m_next + 1) % BUFFER_COUNT;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffers[index]);
+    if (m_sizes[index] < size) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        m_sizes[index] = size;
+    }
+    // 丢弃缓冲区旧内容，驱动在上一次传输未完成时会换一块内存，不会阻塞
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    unsigned char* dst = static_cast<unsigned char*>(mapped);
+    const unsigned char* src = data + (static_cast<size_t>(y) * textureWidth + x) * 4;
+    size_t srcStride = static_cast<size_t>(textureWidth) * 4;
+    if (x == 0 && width == textureWidth) {
+        std::memcpy(dst, src, size);
+    } else {
+        for (int row = 0; row < height; ++row) {
+            std::memcpy(dst + row * rowBytes, src + row * srcStride, rowBytes);
+        }
+    }
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+        // 映射期间缓冲区内容失效（如显示模式切换），改为直接上传
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
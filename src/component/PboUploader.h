@@ -0,0 +1,41 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+/**
+ * @class PboUploader
+ * @brief 经像素缓冲对象（PBO）上传纹理
+ * @description 像素拷贝到映射的 PBO 后由 glTexSubImage2D 从缓冲区读取，
+ *              调用立即返回，实际传输由驱动异步完成，不在主线程等待。
+ *              几个缓冲区轮流使用，每次映射时丢弃旧内容，不需要等待上一次传输。
+ *              只能在 OpenGL 上下文所在的线程使用
+ */
+class PboUploader {
+public:
+    static constexpr int BUFFER_COUNT = 3;
+    static constexpr size_t MIN_UPLOAD_BYTES = 256 * 1024; // 更小的更新直接上传更快
+
+    PboUploader() = default;
+    ~PboUploader();
+    PboUploader(const PboUploader&) = delete;
+    PboUploader& operator=(const PboUploader&) = delete;
+
+    // 创建缓冲区，OpenGL 版本不支持时返回 false
+    bool initialize();
+    // 删除缓冲区（上下文销毁前调用）
+    void release();
+
+    /**
+     * @brief 上传 RGBA 纹理的一个矩形区域
+     * @param texture OpenGL 纹理
+     * @param textureWidth 纹理宽度，data 按此宽度排列（指向整张图起点）
+     * @return 区域太小或映射失败时返回 false，由调用者按原方式上传
+     */
+    bool upload(GLuint texture, int textureWidth, int x, int y, int width, int height, const unsigned char* data);
+
+private:
+    GLuint m_buffers[BUFFER_COUNT] = {0};
+    size_t m_sizes[BUFFER_COUNT] = {0};
+    int m_next = 0;
+    bool m_initialized = false;
+};
@@ -1,57 +1,152 @@
 #include "TextureCacheData.h"
+#include "../utils/DecodePool.h"
+#include "../utils/ImageDecoder.h"
+#include "../utils/PreviewCache.h"
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
 
+namespace {
+// 释放解码结果（原图及金字塔层级）
+void releaseImageData(const ImageData& imageData, const fs::path& path) {
+    unsigned char* mutableData = imageData.data;
+    FreeImage(mutableData, path.generic_string());
+    std::vector<ImageLevel> levels = imageData.levels;
+    FreeImageLevels(levels);
+}
+}
+
 TextureCaches::TextureCaches(NVGcontext* vg) : nvgContext(vg) {
-    workerThread = std::thread(&TextureCaches::workerThreadFunc, this);
 }
 
 TextureCaches::~TextureCaches() {
     shouldStop = true;
-    queueCondition.notify_all();
-    if (workerThread.joinable()) {
-        workerThread.join();
+    // 等待线程池中属于本缓存的任务全部结束
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        pendingCondition.wait(lock, [this] { return pendingTasks == 0; });
     }
     cleanup();
+    discardUploads();
 }
 
-void TextureCaches::workerThreadFunc() {
-    while (!shouldStop) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [this] { return !loadQueue.empty() || shouldStop; });
-        
-        if (shouldStop) break;
-        
-        fs::path path = loadQueue.front();
-        loadQueue.pop();
-        lock.unlock();
-        
-        // 检查是否已经在缓存中
-        {
-            std::lock_guard<std::mutex> cacheLock(cacheMutex);
-            auto it = cache.find(path);
-            if (it != cache.end() && (it->second.loaded || it->second.loading)) {
-                continue;
+void TextureCaches::submitDecodeTask(const fs::path& path, int priority, const DecodePool::CancelFlag& cancelFlag) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        ++pendingTasks;
+    }
+    // 任务对象析构时（执行完毕，或被线程池丢弃/挤出队列）回收请求状态
+    std::shared_ptr<void> guard(nullptr, [this, path, cancelFlag](void*) {
+        finishDecodeTask(path, cancelFlag);
+    });
+    bool submitted = DecodePool::getInstance().submit([this, path, cancelFlag, guard]() {
+        decodeTask(path, cancelFlag);
+    }, priority, cancelFlag);
+    if (!submitted) {
+        // 队列已满且优先级不够，等线程池有空位时由 processMainThreadTasks 重新提交
+        requestsDeferred = true;
+    }
+}
+
+void TextureCaches::decodeTask(const fs::path& path, const DecodePool::CancelFlag& cancelFlag) {
+    bool fullResolution = false;
+    bool hasTextures = false;
+    bool visible = false;
+    // 条目已被移除或换成了新请求，说明本任务已过期
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        auto it = cache.find(path);
+        if (shouldStop || cancelFlag->load() || it == cache.end() || it->second.cancelFlag != cancelFlag) {
+            return;
+        }
+        it->second.decoding = true;
+        fullResolution = it->second.wantFullResolution;
+        hasTextures = it->second.loaded;
+        visible = it->second.priority == DecodePool::PRIORITY_VISIBLE;
+    }
+
+    // 先上传占位图，完整解码继续进行：优先使用磁盘预览图，当前图片没有时缩小解码一份
+    bool previewHit = false;
+    if (!hasTextures) {
+        ImageData preview = loadPreviewData(path);
+        previewHit = preview.data != nullptr;
+        if (!preview.data && visible) {
+            preview = loadCoarseData(path, cancelFlag.get());
+        }
+        if (preview.data) {
+            bool current = false;
+            {
+                std::lock_guard<std::mutex> cacheLock(cacheMutex);
+                auto it = cache.find(path);
+                current = it != cache.end() && it->second.cancelFlag == cancelFlag && !cancelFlag->load();
             }
-            cache[path].loading = true;
+            // 提交后请求才被取消时，由 createTexturesFromData 丢弃
+            if (!current) {
+                releaseImageData(preview, path);
+                return;
+            }
+            postUpload(path, preview);
         }
-        
-        // 在后台线程中只加载图像数据
-        ImageData imageData = loadImageData(path);
-        
-        if (imageData.data) {
-            // 将纹理创建任务提交到主线程
-            std::lock_guard<std::mutex> mainLock(mainThreadMutex);
-            mainThreadTasks.push([this, path, imageData]() {
-                createTexturesFromData(path, imageData);
-            });
-        } else {
-            std::lock_guard<std::mutex> cacheLock(cacheMutex);
-            cache.erase(path);
-            std::cerr << "Failed to load image data: " << path << std::endl;
+    }
+
+    // 在后台线程中只加载图像数据，取消后停止读取文件
+    ImageData imageData = loadImageData(path, cancelFlag.get(), fullResolution);
+
+    // 首次打开的大图写入磁盘预览缓存
+    if (!previewHit && imageData.data && imageData.frames == 1 && !cancelFlag->load()) {
+        PreviewCache::getInstance().store(path, imageData.data, imageData.width, imageData.height,
+                                          imageData.sourceWidth, imageData.sourceHeight);
+    }
+
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        auto it = cache.find(path);
+        bool current = (it != cache.end() && it->second.cancelFlag == cancelFlag);
+        if (!(imageData.data || imageData.tiled) || !current || cancelFlag->load()) {
+            releaseImageData(imageData, path);
+            if (current) {
+                abandonRequest(it);
+            }
+            if (!cancelFlag->load() && !imageData.animated) {
+                std::cerr << "Failed to load image data: " << path << std::endl;
+            }
+            return;
+        }
+        it->second.cancelFlag.reset();
+    }
+    // 在锁外提交：队列满时要等主线程上传，而上传需要 cacheMutex
+    if (!postUpload(path, imageData)) {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        auto it = cache.find(path);
+        if (it != cache.end() && !it->second.cancelFlag) {
+            abandonRequest(it);
+        }
+    }
+}
+
+bool TextureCaches::postUpload(const fs::path& path, ImageData& imageData) {
+    UploadRecord record{path, std::move(imageData)};
+    if (uploads.push(record, shouldStop)) {
+        return true;
+    }
+    releaseImageData(record.image, path);
+    return false;
+}
+
+void TextureCaches::finishDecodeTask(const fs::path& path, const DecodePool::CancelFlag& cancelFlag) {
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        auto it = cache.find(path);
+        if (it != cache.end() && it->second.cancelFlag == cancelFlag) {
+            // 任务未执行就被丢弃，移除 loading 标记以便重新请求
+            abandonRequest(it);
         }
     }
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    if (--pendingTasks == 0) {
+        pendingCondition.notify_all();
+    }
 }
 
 ImageType TextureCaches::detectImageType(const fs::path& path) {
@@ -69,7 +164,64 @@ ImageType TextureCaches::detectImageType(const fs::path& path) {
     return UNKNOWN;
 }
 
-ImageData TextureCaches::loadImageData(const fs::path& path) {
+ImageType TextureCaches::imageTypeFromFormat(ImageFormat format, ImageType fallback) {
+    switch (format) {
+        case ImageFormat::PNG: return PNG;
+        case ImageFormat::JPEG: return JPG;
+        case ImageFormat::GIF: return GIF;
+        case ImageFormat::BMP: return BMP;
+        case ImageFormat::TIFF: return TIFF;
+        case ImageFormat::HDR: return HDR;
+        default: return fallback;
+    }
+}
+
+ImageData TextureCaches::loadPreviewData(const fs::path& path) {
+    ImageData result;
+    result.type = detectImageType(path);
+    if (result.type == GIF || result.type == UNKNOWN) return result;
+
+    result.data = PreviewCache::getInstance().load(path, result.width, result.height, result.sourceWidth, result.sourceHeight);
+    if (result.data) {
+        // 预览图不含 EXIF，信息面板所需的元数据在这里读取文件头，不留给渲染线程
+        result.metadata = ReadImageMetadata(path.generic_string());
+        result.hasMetadata = true;
+    }
+    result.channels = 4;
+    result.frames = 1;
+    result.fullResolution = false;
+    result.preview = true;
+    return result;
+}
+
+ImageData TextureCaches::loadCoarseData(const fs::path& path, const std::atomic<bool>* cancel) {
+    ImageData result;
+    result.type = detectImageType(path);
+    if (result.type == GIF || result.type == UNKNOWN) return result;
+
+    // EXIF 缩略图只需解码文件头中的几 KB 数据，没有时再缩小解码原图
+    MappedFile file(path.generic_string(), EXIF_WINDOW);
+    if (!file.isOpen()) return result;
+    result.metadata = ReadImageMetadata(file);
+    result.hasMetadata = true;
+    result.data = LoadExifThumbnail(file, result.width, result.height, result.sourceWidth, result.sourceHeight);
+    if (!result.data && file.open(path.generic_string())) {
+        MappedReadGuard guard(file);
+        result.data = ImageDecoderRegistry::getInstance().decodeReduced(file.data(), file.size(), COARSE_MIN_SIZE,
+                                                                        result.width, result.height,
+                                                                        result.sourceWidth, result.sourceHeight, cancel);
+        if (result.data && guard.failed()) {
+            FreeImage(result.data, "");
+        }
+    }
+    result.channels = 4;
+    result.frames = 1;
+    result.fullResolution = false;
+    result.preview = true;
+    return result;
+}
+
+ImageData TextureCaches::loadImageData(const fs::path& path, const std::atomic<bool>* cancel, bool fullResolution) {
     ImageData result;
     result.type = detectImageType(path);
     std::string pathStr = path.generic_string();
@@ -77,25 +229,141 @@ ImageData TextureCaches::loadImageData(const fs::path& path) {
     if (result.type == GIF) {
         // result.data = loadGifImage(pathStr, result.width, result.height, result.channels, result.frames);
     } else if (result.type != UNKNOWN) {
-        result.data = LoadImage(pathStr, result.width, result.height, result.channels);
+        // 只打开一次文件，分块探测和解码共用
+        MappedFile file(pathStr);
+        // 需要原图的超大图若能按行解码，直接分块写入临时文件，不整幅解码到内存
+        if (fullResolution) {
+            result.tiled = TiledImage::open(file, cancel);
+            if (result.tiled) {
+                result.width = result.sourceWidth = result.tiled->getWidth();
+                result.height = result.sourceHeight = result.tiled->getHeight();
+                result.channels = 4;
+                result.frames = 1;
+                result.fullResolution = true;
+                result.type = imageTypeFromFormat(DetectImageFormat(file.data(), file.size()), result.type);
+                result.metadata = ReadImageMetadata(file);
+                result.hasMetadata = true;
+                return result;
+            }
+        }
+        // 映射一次文件，解码和 EXIF 解析共用
+        ImageLoadResult loaded = OpenImage(file, pathStr, 4, cancel);
+        result.data = loaded.pixels;
+        result.width = loaded.width;
+        result.height = loaded.height;
+        result.channels = loaded.channels;
+        // 扩展名与内容不符时以文件头为准
+        if (loaded.pixels) {
+            result.type = imageTypeFromFormat(loaded.format, result.type);
+        }
+        result.metadata = loaded.metadata;
+        result.hasMetadata = loaded.pixels != nullptr;
+        result.animated = loaded.animated;
         result.frames = 1;
     }
+    result.sourceWidth = result.width;
+    result.sourceHeight = result.height;
+
+    // 大图按显示尺寸缩小后再上传，放大时再按需加载原图
+    if (result.data && result.frames == 1 && !fullResolution) {
+        int maxWidth = fitWidth.load();
+        int maxHeight = fitHeight.load();
+        if (maxWidth > 0 && maxHeight > 0) {
+            result.fullResolution = !ResizeImageToFit(result.data, result.width, result.height, maxWidth, maxHeight);
+        }
+    }
+
+    // 超过最大纹理尺寸时改为分块，概览图也在工作线程生成
+    if (result.data && result.frames == 1 && TiledImage::needsTiling(result.width, result.height)) {
+        result.tiled = std::make_shared<TiledImage>(result.data, result.width, result.height);
+        result.data = nullptr;
+        if (!result.tiled->isValid()) {
+            result.tiled.reset();
+        }
+        return result;
+    }
+
+    // 缩小显示时使用的层级，与解码一起在工作线程生成
+    if (result.data && result.frames == 1 && !(cancel && cancel->load())) {
+        result.levels = BuildImagePyramid(result.data, result.width, result.height);
+    }
     
     return result;
 }
 
-void TextureCaches::createTexturesFromData(const fs::path& path, const ImageData& imageData) {
-    if (!imageData.data) return;
+bool TextureCaches::isUploadWanted(const fs::path& path, const ImageData& imageData) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    return it != cache.end() && !(imageData.preview && (!it->second.loading || (it->second.loaded && !it->second.preview)));
+}
+
+bool TextureCaches::uploadBands(UploadJob& job, bool unlimited, std::chrono::steady_clock::time_point deadline) {
+    const ImageData& image = job.image;
+    size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    // 小图、分块图和多帧图整张上传
+    if (!image.data || image.tiled || image.frames != 1 || rowBytes * image.height <= UPLOAD_BAND_BYTES) {
+        return true;
+    }
+    // 每帧继续之前确认仍然需要，已取消的请求交给 createTexturesFromData 释放
+    if (!isUploadWanted(job.path, image)) {
+        return true;
+    }
+    if (job.textureId == -1) {
+        job.textureId = nvgCreateImageRGBA(nvgContext, image.width, image.height, 0, nullptr);
+        if (job.textureId == -1) return true;
+    }
+
+    int bandRows = static_cast<int>(std::max<size_t>(1, UPLOAD_BAND_BYTES / rowBytes));
+    NVGparams* params = nvgInternalParams(nvgContext);
+    while (job.uploadedRows < image.height) {
+        int rows = std::min(bandRows, image.height - job.uploadedRows);
+        // data 仍指向整张图起点，后端按纹理宽度跳过已上传的行
+        params->renderUpdateTexture(params->userPtr, job.textureId, 0, job.uploadedRows, image.width, rows, image.data);
+        job.uploadedRows += rows;
+        if (!unlimited && job.uploadedRows < image.height && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TextureCaches::createTexturesFromData(const fs::path& path, const ImageData& imageData, int uploadedTexture) {
+    if (!imageData.data && !imageData.tiled) return;
+    
+    // 解码期间条目已被释放（用户已切换到别处），或完整纹理已先到达时直接丢弃数据
+    if (!isUploadWanted(path, imageData)) {
+        if (uploadedTexture != -1) {
+            nvgDeleteImage(nvgContext, uploadedTexture);
+        }
+        releaseImageData(imageData, path);
+        return;
+    }
     
     TextureCacheData cacheData;
     cacheData.type = imageData.type;
-    cacheData.width = imageData.width;
-    cacheData.height = imageData.height;
+    cacheData.width = imageData.sourceWidth;
+    cacheData.height = imageData.sourceHeight;
+    cacheData.textureWidth = imageData.width;
+    cacheData.textureHeight = imageData.height;
+    cacheData.fullResolution = imageData.fullResolution;
+    cacheData.preview = imageData.preview;
+    cacheData.hasMetadata = imageData.hasMetadata;
+    cacheData.metadata = imageData.metadata;
     cacheData.channels = imageData.channels;
     cacheData.frame_count = imageData.frames;
     cacheData.imageId.clear();
     
-    if (imageData.type == GIF && imageData.frames > 1) {
+    if (imageData.tiled) {
+        // 超大图只上传概览图，原图图块由 UITexture 按视口上传
+        int textureId = imageData.tiled->uploadOverview(nvgContext);
+        if (textureId != -1) {
+            cacheData.imageId.push_back(textureId);
+            cacheData.tiled = imageData.tiled;
+        } else {
+            std::cerr << "[TextureCache] Failed to create overview texture for: " << path.filename() << std::endl;
+            imageData.tiled->release(nvgContext);
+        }
+    } else if (imageData.type == GIF && imageData.frames > 1) {
         // GIF 多帧处理
         std::cout << "[TextureCache] Creating " << imageData.frames << " GPU textures for GIF..." << std::endl;
         cacheData.imageId.reserve(imageData.frames);
@@ -119,19 +387,26 @@ void TextureCaches::createTexturesFromData(const fs::path& path, const ImageData
     } else {
         // 普通图片处理
         std::cout << "[TextureCache] Creating single GPU texture..." << std::endl;
-        int textureId = nvgCreateImageRGBA(nvgContext, imageData.width, imageData.height, 0, imageData.data);
+        int textureId = uploadedTexture != -1 ? uploadedTexture
+                                              : nvgCreateImageRGBA(nvgContext, imageData.width, imageData.height, 0, imageData.data);
         if (textureId != -1) {
             cacheData.imageId.push_back(textureId);
             std::cout << "[TextureCache] GPU texture created successfully (ID: " << textureId << ")" << std::endl;
         }else {
             std::cerr << "[TextureCache] Failed to create GPU texture for: " << path.filename() << std::endl;
         }
+        // 金字塔层级，缺失某一级时渲染退回到更大的层级
+        if (textureId != -1) {
+            for (const auto& level : imageData.levels) {
+                int levelId = nvgCreateImageRGBA(nvgContext, level.width, level.height, 0, level.data);
+                if (levelId == -1) break;
+                cacheData.levels.push_back({levelId, level.width, level.height});
+            }
+        }
     }
     
     // 释放图像数据
-    std::string pathStr = path.generic_string();
-    unsigned char* mutableData = const_cast<unsigned char*>(imageData.data);
-    FreeImage(mutableData, pathStr);
+    releaseImageData(imageData, path);
     std::cout << "[TextureCache] Released image data memory for: " << path.filename() << std::endl;
     // 更新缓存
     {
@@ -139,64 +414,359 @@ void TextureCaches::createTexturesFromData(const fs::path& path, const ImageData
         if (!cacheData.imageId.empty()) {
             cacheData.loading = false;
             cacheData.loaded = true;
-            cache[path] = cacheData;
+            cacheData.bytes = static_cast<size_t>(cacheData.textureWidth) * cacheData.textureHeight * 4 * cacheData.imageId.size();
+            for (const auto& level : cacheData.levels) {
+                cacheData.bytes += static_cast<size_t>(level.width) * level.height * 4;
+            }
+            if (cacheData.tiled) {
+                // 概览图加上常驻图块的上限
+                cacheData.bytes = cacheData.tiled->getOverviewBytes() + TiledImage::getTileBudgetBytes();
+            }
+            cacheData.lastUsed = ++useCounter;
+            TextureCacheData& entry = cache[path];
+            if (cacheData.preview) {
+                // 预览图只是占位，完整解码的请求状态保持不变
+                cacheData.loading = entry.loading;
+                cacheData.decoding = entry.decoding;
+                cacheData.priority = entry.priority;
+                cacheData.generation = entry.generation;
+                cacheData.cancelFlag = entry.cancelFlag;
+                cacheData.wantFullResolution = entry.wantFullResolution;
+            }
+            if (entry.loaded) {
+                // 同一图片被重复上传（取消后又重新请求、预览图被完整解码替换，或缩小的纹理升级为原图），释放旧纹理
+                deleteTextures(entry);
+            }
+            entry = cacheData;
+            usedBytes += entry.bytes;
             std::cout << "[TextureCache] ✓ Successfully cached: " << path.filename() 
-                      << " (" << cacheData.width << "x" << cacheData.height << ", " 
-                      << cacheData.imageId.size() << " textures)" << std::endl;
+                      << " (" << cacheData.textureWidth << "x" << cacheData.textureHeight << ", " 
+                      << cacheData.imageId.size() << " textures, " << cacheData.levels.size() << " levels, "
+                      << usedBytes / (1024 * 1024) << "/" << memoryBudget / (1024 * 1024) << " MB)" << std::endl;
+            evictToBudget();
+        } else if (imageData.preview) {
+            // 预览图上传失败，等待完整解码
         } else {
-            cache.erase(path);
+            // 已有纹理（预览图或缩小的纹理）的条目保留原纹理
+            auto it = cache.find(path);
+            if (it != cache.end()) {
+                abandonRequest(it);
+            }
             std::cerr << "[TextureCache] ✗ Failed to create textures for: " << path.filename() << std::endl;
         }
     }
 }
 
 void TextureCaches::processMainThreadTasks() {
-    std::queue<std::function<void()>> tasksToProcess;
-    {
-        std::lock_guard<std::mutex> lock(mainThreadMutex);
-        tasksToProcess = std::move(mainThreadTasks);
+    if (requestsDeferred && DecodePool::getInstance().hasCapacity()) {
+        requestsDeferred = false;
+        submitImages(requestedPaths);
     }
-    
-    while (!tasksToProcess.empty()) {
-        auto task = std::move(tasksToProcess.front());
-        tasksToProcess.pop();
+
+    uploads.drain([this](UploadRecord& record) {
+        uploadJobs.push_back(UploadJob{std::move(record.path), std::move(record.image)});
+    });
+    if (uploadJobs.empty()) return;
+
+    // 当前显示的图片排到最前，同一图片的预览图与完整纹理保持先后顺序
+    if (!visiblePath.empty()) {
+        std::stable_partition(uploadJobs.begin(), uploadJobs.end(),
+                              [this](const UploadJob& job) { return job.path == visiblePath; });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(static_cast<long long>(uploadBudgetMs * 1000.0));
+    bool uploaded = false;
+    while (!uploadJobs.empty()) {
+        UploadJob& job = uploadJobs.front();
+        bool unlimited = !visiblePath.empty() && job.path == visiblePath;
+        // 每帧至少推进一个任务，预算再小也不会停滞
+        if (!unlimited && uploaded && std::chrono::steady_clock::now() >= deadline) break;
+        uploaded = true;
+        if (!uploadBands(job, unlimited, deadline)) break;
+
+        UploadJob finished = std::move(job);
+        uploadJobs.pop_front();
         try {
-            task();
+            createTexturesFromData(finished.path, finished.image, finished.textureId);
         } catch (const std::exception& e) {
             std::cerr << "Exception in main thread task: " << e.what() << std::endl;
         }
     }
 }
 
-bool TextureCaches::getImageCacheData(const fs::path& path, int& width, int& height, int& frame_count, std::vector<int>& imageId) {
+void TextureCaches::setUploadBudget(double milliseconds) {
+    uploadBudgetMs = std::max(0.0, milliseconds);
+}
+
+void TextureCaches::discardUploads() {
+    uploads.drain([](UploadRecord& record) {
+        releaseImageData(record.image, record.path);
+    });
+    for (auto& job : uploadJobs) {
+        if (job.textureId != -1) {
+            nvgDeleteImage(nvgContext, job.textureId);
+        }
+        releaseImageData(job.image, job.path);
+    }
+    uploadJobs.clear();
+}
+
+bool TextureCaches::getImageCacheData(const fs::path& path, int& width, int& height, int& frame_count, std::vector<int>& imageId,
+                                      std::vector<TextureLevel>* levels, std::shared_ptr<TiledImage>* tiled) {
     std::lock_guard<std::mutex> lock(cacheMutex);
     auto it = cache.find(path);
     if (it != cache.end() && it->second.loaded) {
+        it->second.lastUsed = ++useCounter;
         width = it->second.width;
         height = it->second.height;
         frame_count = it->second.frame_count;
         imageId = it->second.imageId;
+        if (levels) {
+            *levels = it->second.levels;
+        }
+        if (tiled) {
+            *tiled = it->second.tiled;
+        }
         return true;
     }
     return false;
 }
 
-void TextureCaches::preloadImages(const std::vector<fs::path>& imagePaths) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    for (const auto& path : imagePaths) {
-        loadQueue.push(path);
+bool TextureCaches::getImageMetadata(const fs::path& path, ImageMetadata& metadata) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it == cache.end() || !it->second.loaded || !it->second.hasMetadata) return false;
+    metadata = it->second.metadata;
+    return true;
+}
+
+int TextureCaches::getImageTexture(const fs::path& path, int frameIndex) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it == cache.end() || !it->second.loaded ||
+        frameIndex < 0 || frameIndex >= static_cast<int>(it->second.imageId.size())) {
+        return -1;
     }
-    queueCondition.notify_all();
+    return it->second.imageId[frameIndex];
 }
 
-void TextureCaches::cleanup() {
+bool TextureCaches::isImageLoaded(const fs::path& path) {
     std::lock_guard<std::mutex> lock(cacheMutex);
-    for (auto& pair : cache) {
-        for (int texId : pair.second.imageId) {
+    auto it = cache.find(path);
+    return it != cache.end() && it->second.loaded;
+}
+
+bool TextureCaches::isImageLoading(const fs::path& path) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    return it != cache.end() && it->second.loading;
+}
+
+uint64_t TextureCaches::beginGeneration() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return ++currentGeneration;
+}
+
+void TextureCaches::preloadImages(const std::vector<fs::path>& imagePaths, const fs::path& visible) {
+    // 先把本批路径标记为当前批次，再取消过时请求，腾出队列位置后提交
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        for (const auto& path : imagePaths) {
+            auto it = cache.find(path);
+            if (it != cache.end()) {
+                it->second.generation = currentGeneration;
+            }
+        }
+    }
+    cancelStaleRequests();
+    requestedPaths = imagePaths;
+    visiblePath = visible;
+    requestsDeferred = false;
+    submitImages(imagePaths);
+}
+
+void TextureCaches::submitImages(const std::vector<fs::path>& imagePaths) {
+    for (size_t i = 0; i < imagePaths.size(); ++i) {
+        const fs::path& path = imagePaths[i];
+        // GIF 多帧及延时由 UITexture 自行加载，这里只预取静态图
+        ImageType type = detectImageType(path);
+        if (type == GIF || type == UNKNOWN) continue;
+
+        // 只有当前显示的图片使用 PRIORITY_VISIBLE（会先生成缩小解码的占位图），其余按请求顺序排在后面
+        int priority = path == visiblePath ? DecodePool::PRIORITY_VISIBLE : static_cast<int>(i) + 1;
+        DecodePool::CancelFlag cancelFlag;
+        {
+            std::lock_guard<std::mutex> cacheLock(cacheMutex);
+            TextureCacheData& entry = cache[path];
+            entry.generation = currentGeneration;
+            // 只有预览图的条目仍需完整解码
+            if (entry.loaded && !entry.preview) continue;
+            if (entry.loading) {
+                // 仍在排队且优先级提升（例如邻居变成了当前图片）时重新排队，运行中的任务不打断
+                if (entry.decoding || !entry.cancelFlag || priority >= entry.priority) continue;
+                entry.cancelFlag->store(true);
+            }
+            entry.loading = true;
+            entry.decoding = false;
+            entry.priority = priority;
+            entry.cancelFlag = DecodePool::makeCancelFlag();
+            cancelFlag = entry.cancelFlag;
+        }
+        submitDecodeTask(path, priority, cancelFlag);
+    }
+}
+
+void TextureCaches::cancelStaleRequests() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (auto it = cache.begin(); it != cache.end();) {
+        TextureCacheData& entry = it->second;
+        bool pinned = std::find(pinnedPaths.begin(), pinnedPaths.end(), it->first) != pinnedPaths.end();
+        if (entry.loading && entry.cancelFlag && entry.generation != currentGeneration && !pinned) {
+            entry.cancelFlag->store(true);
+            std::cout << "[TextureCache] Cancelled: " << it->first.filename() << std::endl;
+            if (entry.loaded) {
+                abandonRequest(it++);
+            } else {
+                it = cache.erase(it);
+            }
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TextureCaches::abandonRequest(std::unordered_map<fs::path, TextureCacheData>::iterator it) {
+    TextureCacheData& entry = it->second;
+    if (!entry.loaded) {
+        cache.erase(it);
+        return;
+    }
+    entry.loading = false;
+    entry.decoding = false;
+    entry.wantFullResolution = false;
+    entry.cancelFlag.reset();
+}
+
+void TextureCaches::deleteTextures(TextureCacheData& data) {
+    if (data.tiled) {
+        // 概览图和图块归 TiledImage 所有，一并释放，仍持有该对象的 UITexture 不再绘制
+        data.tiled->release(nvgContext);
+        data.tiled.reset();
+    } else {
+        for (int texId : data.imageId) {
             if (texId != -1) {
                 nvgDeleteImage(nvgContext, texId);
             }
         }
     }
+    data.imageId.clear();
+    for (const auto& level : data.levels) {
+        nvgDeleteImage(nvgContext, level.image);
+    }
+    data.levels.clear();
+    usedBytes -= std::min(usedBytes, data.bytes);
+    data.bytes = 0;
+}
+
+bool TextureCaches::removeImageCacheData(const fs::path& path) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it == cache.end()) return false;
+    if (it->second.cancelFlag) {
+        it->second.cancelFlag->store(true);
+    }
+    deleteTextures(it->second);
+    cache.erase(it);
+    return true;
+}
+
+void TextureCaches::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+void TextureCaches::setPinnedImages(const std::vector<fs::path>& paths) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    pinnedPaths = paths;
+    evictToBudget();
+}
+
+size_t TextureCaches::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return usedBytes;
+}
+
+void TextureCaches::setFitSize(int maxWidth, int maxHeight) {
+    fitWidth = std::max(0, maxWidth);
+    fitHeight = std::max(0, maxHeight);
+}
+
+bool TextureCaches::requestFullResolution(const fs::path& path) {
+    DecodePool::CancelFlag cancelFlag;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(path);
+        if (it == cache.end() || !it->second.loaded || it->second.fullResolution) return false;
+        TextureCacheData& entry = it->second;
+        if (entry.loading) return true; // 已在加载原图
+
+        entry.loading = true;
+        entry.decoding = false;
+        entry.wantFullResolution = true;
+        entry.priority = DecodePool::PRIORITY_VISIBLE;
+        entry.generation = currentGeneration;
+        entry.cancelFlag = DecodePool::makeCancelFlag();
+        cancelFlag = entry.cancelFlag;
+    }
+    std::cout << "[TextureCache] Loading full resolution: " << path.filename() << std::endl;
+    submitDecodeTask(path, DecodePool::PRIORITY_VISIBLE, cancelFlag);
+    return true;
+}
+
+bool TextureCaches::getTextureResolution(const fs::path& path, int& textureWidth, int& textureHeight, bool& fullResolution) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it == cache.end() || !it->second.loaded) return false;
+    textureWidth = it->second.textureWidth;
+    textureHeight = it->second.textureHeight;
+    fullResolution = it->second.fullResolution;
+    return true;
+}
+
+void TextureCaches::evictToBudget() {
+    while (usedBytes > memoryBudget) {
+        auto victim = cache.end();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (!it->second.loaded) continue;
+            if (std::find(pinnedPaths.begin(), pinnedPaths.end(), it->first) != pinnedPaths.end()) continue;
+            if (victim == cache.end() || it->second.lastUsed < victim->second.lastUsed) {
+                victim = it;
+            }
+        }
+        // 剩下的都是固定的图片，允许暂时超出预算
+        if (victim == cache.end()) break;
+
+        std::cout << "[TextureCache] Evicted: " << victim->first.filename()
+                  << " (" << victim->second.bytes / (1024 * 1024) << " MB)" << std::endl;
+        // 仍在加载原图（或完整解码）的条目同时取消其任务，解码结果不再上传
+        if (victim->second.cancelFlag) {
+            victim->second.cancelFlag->store(true);
+        }
+        deleteTextures(victim->second);
+        cache.erase(victim);
+    }
+}
+
+void TextureCaches::cleanup() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (auto& pair : cache) {
+        if (pair.second.cancelFlag) {
+            pair.second.cancelFlag->store(true);
+        }
+        deleteTextures(pair.second);
+    }
     cache.clear();
+    usedBytes = 0;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <chrono>
 #include <functional>
 #include <algorithm>
 #include <filesystem>
@@ -12,6 +14,9 @@
 #include <condition_variable>
 #include <filesystem>
 #include "../utils/utils.h"
+#include "../utils/DecodePool.h"
+#include "../utils/SpscRing.h"
+#include "TiledImage.h"
 #include "nanovg.h"
 
 namespace fs = std::filesystem;
@@ -27,6 +32,21 @@ struct ImageData {
     int channels = 0;
     int frames = 0;
     ImageType type = UNKNOWN;
+    int sourceWidth = 0;              // 原图尺寸，按显示尺寸缩小解码时与 width/height 不同
+    int sourceHeight = 0;
+    bool fullResolution = true;
+    std::vector<ImageLevel> levels;   // 解码线程生成的缩小层级
+    std::shared_ptr<TiledImage> tiled; // 超过最大纹理尺寸时代替 data
+    bool preview = false;             // 占位图：磁盘预览图或缩小解码的结果
+    bool hasMetadata = false;         // 解码时与像素一起得到，占位图另读文件头
+    ImageMetadata metadata;
+    bool animated = false;            // 按文件头识别为动画，交给 UITexture 播放
+};
+
+// 解码完成、等待主线程上传的结果
+struct UploadRecord {
+    fs::path path;
+    ImageData image;
 };
 
 struct TextureCacheData {
@@ -34,47 +54,134 @@ struct TextureCacheData {
     int frame_count = 0;
     bool loading = false;
     bool loaded = false;
-    int width = 0;
+    int width = 0;                    // 原图尺寸
     int height = 0;
     int channels = 0;
+    int textureWidth = 0;             // 纹理实际尺寸，缩小解码时小于原图
+    int textureHeight = 0;
+    bool fullResolution = true;
+    bool wantFullResolution = false;  // 当前解码请求是否要求原图分辨率
+    bool preview = false;             // 纹理是占位图，完整解码完成后替换
+    bool hasMetadata = false;
+    ImageMetadata metadata;           // 解码时一并解析的 EXIF 摘要和旋转角度
     std::vector<int> imageId;
+    std::vector<TextureLevel> levels; // imageId[0] 的逐级缩小纹理，从大到小
+    std::shared_ptr<TiledImage> tiled; // 分块显示的超大图，imageId[0] 为其概览图
+    size_t bytes = 0;                 // 纹理占用的显存（RGBA）
+    uint64_t lastUsed = 0;            // 最近一次显示/上传的序号，用于 LRU 淘汰
+
+    // 解码请求状态（loading 为 true 时有效）
+    bool decoding = false;            // 任务已在工作线程上运行
+    int priority = 0;                 // 提交时的优先级，数值越小越先执行
+    uint64_t generation = 0;          // 最近一次请求所属的批次
+    DecodePool::CancelFlag cancelFlag; // 解码完成后清空
 };
 
 class TextureCaches {
 private:
+    static constexpr int COARSE_MIN_SIZE = 256; // 缩小解码占位图的最小长边
+
     std::unordered_map<fs::path, TextureCacheData> cache;
     std::mutex cacheMutex;
     
-    // 后台线程相关
-    std::thread workerThread;
-    std::queue<fs::path> loadQueue;
-    std::mutex queueMutex;
-    std::condition_variable queueCondition;
+    // 后台解码任务提交到 DecodePool，析构时需等待已提交的任务结束
     std::atomic<bool> shouldStop{false};
+    int pendingTasks = 0;
+    std::mutex pendingMutex;
+    std::condition_variable pendingCondition;
+    uint64_t currentGeneration = 0;
+    // 当前批次的请求列表，队列已满被拒绝的请求在有空位时重新提交（仅主线程访问）
+    std::vector<fs::path> requestedPaths;
+    // 当前显示的图片，不一定在请求列表中（纹理控件已自行加载时）（仅主线程访问）
+    fs::path visiblePath;
+    std::atomic<bool> requestsDeferred{false};
+
+    // 显存预算：超出时按最近最少显示淘汰，固定的图片（当前及相邻）不淘汰
+    size_t memoryBudget = 512ull * 1024 * 1024;
+    size_t usedBytes = 0;
+    uint64_t useCounter = 0;
+    std::vector<fs::path> pinnedPaths;
+
+    // 缩小解码的目标尺寸（0 表示不限制），工作线程读取
+    std::atomic<int> fitWidth{0};
+    std::atomic<int> fitHeight{0};
     
-    // 主线程任务队列
-    std::queue<std::function<void()>> mainThreadTasks;
-    std::mutex mainThreadMutex;
+    // 解码结果经无锁队列交给主线程上传，不与缓存查找争用 cacheMutex
+    UploadQueue<UploadRecord> uploads;
+
+    // 等待上传的纹理（仅主线程访问）：当前图片优先且不受预算限制，
+    // 其余每帧最多上传 uploadBudgetMs，大图按行分段跨帧上传
+    struct UploadJob {
+        fs::path path;
+        ImageData image;
+        int textureId = -1;     // 分段上传中的纹理
+        int uploadedRows = 0;
+    };
+    static constexpr size_t UPLOAD_BAND_BYTES = 4 * 1024 * 1024; // 每段上传的字节数
+    std::deque<UploadJob> uploadJobs;
+    double uploadBudgetMs = 4.0;
     
     NVGcontext* nvgContext;
     
-    void workerThreadFunc();
+    void evictToBudget(); // 调用者持有 cacheMutex
+    void deleteTextures(TextureCacheData& data);
+    void submitImages(const std::vector<fs::path>& imagePaths);
+    void cancelStaleRequests();
+    // 放弃条目上的解码请求：已有纹理的条目（升级原图中）保留，否则移除。调用者持有 cacheMutex
+    void abandonRequest(std::unordered_map<fs::path, TextureCacheData>::iterator it);
+    void submitDecodeTask(const fs::path& path, int priority, const DecodePool::CancelFlag& cancelFlag);
+    void decodeTask(const fs::path& path, const DecodePool::CancelFlag& cancelFlag);
+    // 把解码结果交给主线程，未能提交时释放图像数据（工作线程调用，不能持有 cacheMutex）
+    bool postUpload(const fs::path& path, ImageData& imageData);
+    void finishDecodeTask(const fs::path& path, const DecodePool::CancelFlag& cancelFlag);
+    // 扩展名只用于提交前的快速过滤，解码后按文件头修正
     ImageType detectImageType(const fs::path& path);
-    ImageData loadImageData(const fs::path& path);
-    void createTexturesFromData(const fs::path& path, const ImageData& imageData);
+    static ImageType imageTypeFromFormat(ImageFormat format, ImageType fallback);
+    ImageData loadPreviewData(const fs::path& path);
+    // 当前图片没有磁盘预览图时的占位图：EXIF 缩略图，或按 1/8、1/4 缩小解码
+    ImageData loadCoarseData(const fs::path& path, const std::atomic<bool>* cancel);
+    ImageData loadImageData(const fs::path& path, const std::atomic<bool>* cancel = nullptr, bool fullResolution = true);
+    // 解码期间条目已被释放，或预览图晚于完整纹理到达时不再上传
+    bool isUploadWanted(const fs::path& path, const ImageData& imageData);
+    // 按行分段上传主纹理，超出期限时返回 false，下一帧从中断处继续
+    bool uploadBands(UploadJob& job, bool unlimited, std::chrono::steady_clock::time_point deadline);
+    // uploadedTexture 为已分段上传好的主纹理，-1 时在这里整张上传
+    void createTexturesFromData(const fs::path& path, const ImageData& imageData, int uploadedTexture = -1);
+    void discardUploads();
 
 public:
     TextureCaches(NVGcontext* vg);
     ~TextureCaches();
     
-    // 处理主线程任务（必须在主线程调用）
+    // 上传解码完成的纹理（必须在主线程调用，每帧一次）
     void processMainThreadTasks();
+    // 每帧上传纹理的时间预算（毫秒），当前显示的图片不受限制
+    void setUploadBudget(double milliseconds);
     
-    bool getImageCacheData(const fs::path& path, int& width, int& height, int& frame_count, std::vector<int>& imageId);
+    bool getImageCacheData(const fs::path& path, int& width, int& height, int& frame_count, std::vector<int>& imageId,
+                           std::vector<TextureLevel>* levels = nullptr, std::shared_ptr<TiledImage>* tiled = nullptr);
     bool addImageCacheData(const fs::path& path, const TextureCacheData& data);
     bool removeImageCacheData(const fs::path& path);
-    void preloadImages(const std::vector<fs::path>& imagePaths);
+    // 开始新一批请求，之前批次中未被再次请求的解码（排队或运行中）会在下次 preloadImages 时取消
+    uint64_t beginGeneration();
+    // 按优先级顺序请求解码，已排队的任务优先级提升时会重新排队；
+    // visiblePath 为当前显示的图片，其解码与上传优先且不受每帧预算限制
+    void preloadImages(const std::vector<fs::path>& imagePaths, const fs::path& visiblePath);
+    // 显存预算（字节），以下两个函数可能释放纹理，必须在主线程调用
+    void setMemoryBudget(size_t bytes);
+    // 设置不可淘汰的图片（当前显示及相邻的图片），其解码请求也不会被取消
+    void setPinnedImages(const std::vector<fs::path>& paths);
+    size_t getMemoryUsage();
+    // 预加载按不超过该尺寸缩小解码（0 表示保持原图），已缓存的纹理不受影响
+    void setFitSize(int maxWidth, int maxHeight);
+    // 放大超过缓存纹理分辨率时请求原图，完成后替换该条目的纹理
+    bool requestFullResolution(const fs::path& path);
+    // 查询已缓存纹理的实际尺寸
+    bool getTextureResolution(const fs::path& path, int& textureWidth, int& textureHeight, bool& fullResolution);
+    // 查询解码时解析的元数据，条目不存在或纹理尚未上传时返回 false
+    bool getImageMetadata(const fs::path& path, ImageMetadata& metadata);
     bool isImageLoaded(const fs::path& path);
+    bool isImageLoading(const fs::path& path);
     int getImageTexture(const fs::path& path, int frameIndex = 0);
     void cleanup();
 };
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "TiledImage.h"
+#include "../utils/utils.h"
+#include "../utils/ImageDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+int TiledImage::s_maxTextureSize = 16384;
+
+TiledImage::TiledImage(int width, int height)
+    : m_width(width), m_height(height) {
+    m_columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles.resize(static_cast<size_t>(m_columns) * m_rows);
+    computeOverviewSize();
+}
+
+TiledImage::TiledImage(unsigned char* data, int width, int height)
+    : TiledImage(width, height) {
+    m_data = data;
+    if (!m_data) return;
+    m_overview = ResizeImage(m_data, width, height, m_overviewWidth, m_overviewHeight);
+
+    // 写入临时文件后释放整幅像素，显存之外只剩按需调入的文件页面
+    std::ofstream output;
+    bool written = createSpillFile(output);
+    for (int row = 0; written && row < m_rows; ++row) {
+        int bandHeight = std::min(TILE_SIZE, m_height - row * TILE_SIZE);
+        written = writeBand(output, m_data + static_cast<size_t>(row) * TILE_SIZE * m_width * 4, bandHeight);
+    }
+    if (written) {
+        output.close();
+        written = !output.fail() && mapSpillFile();
+    }
+    if (written) {
+        FreeImage(m_data, "");
+    } else {
+        removeSpillFile();
+    }
+    std::cout << "[TiledImage] " << width << "x" << height << " -> " << m_columns << "x" << m_rows
+              << " tiles, overview " << m_overviewWidth << "x" << m_overviewHeight
+              << (m_data ? ", pixels kept in memory" : ", pixels in spill file") << std::endl;
+}
+
+std::shared_ptr<TiledImage> TiledImage::open(const MappedFile& file, const std::atomic<bool>* cancel) {
+    // 先从文件头读尺寸，不需要分块的图像不必建立解码器
+    int sourceWidth = 0, sourceHeight = 0;
+    if (!ReadImageSize(file, sourceWidth, sourceHeight) || !needsTiling(sourceWidth, sourceHeight)) return nullptr;
+    // 解码持续数秒，期间文件被截断时读到的是零页，发现后停止
+    MappedReadGuard guard(file);
+    std::unique_ptr<RowReader> reader = ImageDecoderRegistry::getInstance().openRows(file.data(), file.size());
+    if (!reader || !needsTiling(reader->getWidth(), reader->getHeight())) return nullptr;
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<TiledImage> image(new TiledImage(reader->getWidth(), reader->getHeight()));
+    const int width = image->m_width;
+    const int height = image->m_height;
+    std::ofstream output;
+    unsigned char* band = nullptr;
+    unsigned char* overview = nullptr;
+    bool ok = image->createSpillFile(output);
+    if (ok) {
+        band = AllocateImage(width, TILE_SIZE);
+        overview = AllocateImage(image->m_overviewWidth, image->m_overviewHeight);
+        ok = band && overview;
+    }
+
+    // 每次解出一行图块：写入临时文件，同时缩小到概览图中对应的行
+    for (int row = 0; ok && row < image->m_rows; ++row) {
+        if ((cancel && cancel->load()) || guard.failed()) {
+            ok = false;
+            break;
+        }
+        int top = row * TILE_SIZE;
+        int bandHeight = std::min(TILE_SIZE, height - top);
+        ok = reader->readRows(band, bandHeight) && image->writeBand(output, band, bandHeight);
+        if (!ok) break;
+
+        int overviewTop = static_cast<int>(static_cast<int64_t>(top) * image->m_overviewHeight / height);
+        int overviewBottom = static_cast<int>(static_cast<int64_t>(top + bandHeight) * image->m_overviewHeight / height);
+        if (overviewBottom > overviewTop) {
+            unsigned char* scaled = ResizeImage(band, width, bandHeight, image->m_overviewWidth, overviewBottom - overviewTop);
+            if (!scaled) {
+                ok = false;
+                break;
+            }
+            size_t overviewRowBytes = static_cast<size_t>(image->m_overviewWidth) * 4;
+            std::memcpy(overview + overviewTop * overviewRowBytes, scaled, (overviewBottom - overviewTop) * overviewRowBytes);
+            FreeImage(scaled, "");
+        }
+    }
+    FreeImage(band, "");
+    ok = ok && !guard.failed();
+    if (ok) {
+        output.close();
+        ok = !output.fail() && image->mapSpillFile();
+    }
+    if (!ok) {
+        FreeImage(overview, "");
+        image->removeSpillFile();
+        return nullptr;
+    }
+    image->m_overview = overview;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[TiledImage] " << width << "x" << height << " -> " << image->m_columns << "x" << image->m_rows
+              << " tiles, decoded by rows in " << seconds << " s, overview "
+              << image->m_overviewWidth << "x" << image->m_overviewHeight << std::endl;
+    return image;
+}
+
+TiledImage::~TiledImage() {
+    if (m_residentTiles > 0 || m_overviewImage != -1) {
+        std::cerr << "[TiledImage] Destroyed with live textures" << std::endl;
+    }
+    unsigned char* data = m_data;
+    FreeImage(data, "");
+    unsigned char* overview = m_overview;
+    FreeImage(overview, "");
+    m_spill.close();
+    removeSpillFile();
+}
+
+void TiledImage::computeOverviewSize() {
+    double scale = std::min(1.0, static_cast<double>(OVERVIEW_SIZE) / std::max(m_width, m_height));
+    m_overviewWidth = std::max(1, static_cast<int>(m_width * scale + 0.5));
+    m_overviewHeight = std::max(1, static_cast<int>(m_height * scale + 0.5));
+}
+
+bool TiledImage::createSpillFile(std::ofstream& output) {
+    static std::atomic<unsigned> counter{0};
+    fs::path directory = getCacheDirectory("tiles");
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    m_spillPath = directory / ("tiles-" + std::to_string(stamp) + "-" + std::to_string(counter++) + ".rgba");
+    output.open(m_spillPath, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        std::cerr << "[TiledImage] Cannot create spill file " << m_spillPath << std::endl;
+        m_spillPath.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TiledImage::writeBand(std::ofstream& output, const unsigned char* band, int bandHeight) {
+    // 同一行图块依次写出，每个图块的像素连续存放
+    size_t bandRowBytes = static_cast<size_t>(m_width) * 4;
+    for (int column = 0; column < m_columns; ++column) {
+        int tileX = column * TILE_SIZE;
+        size_t rowBytes = static_cast<size_t>(std::min(TILE_SIZE, m_width - tileX)) * 4;
+        for (int y = 0; y < bandHeight; ++y) {
+            output.write(reinterpret_cast<const char*>(band + y * bandRowBytes + static_cast<size_t>(tileX) * 4),
+                         static_cast<std::streamsize>(rowBytes));
+        }
+    }
+    return static_cast<bool>(output);
+}
+
+bool TiledImage::mapSpillFile() {
+    if (!m_spill.open(m_spillPath.string()) ||
+        m_spill.size() != static_cast<size_t>(m_width) * m_height * 4) {
+        m_spill.close();
+        return false;
+    }
+#if !defined(_WIN32)
+    // 映射建立后删除文件名，程序异常退出也不会留下临时文件
+    removeSpillFile();
+#endif
+    return true;
+}
+
+void TiledImage::removeSpillFile() {
+    if (m_spillPath.empty()) return;
+    std::error_code ec;
+    fs::remove(m_spillPath, ec);
+    m_spillPath.clear();
+}
+
+size_t TiledImage::tileOffset(int column, int row) const {
+    // 前面每行图块都是 TILE_SIZE 行整幅宽度，本行中每个图块宽 TILE_SIZE
+    size_t bandHeight = static_cast<size_t>(std::min(TILE_SIZE, m_height - row * TILE_SIZE));
+    return (static_cast<size_t>(row) * TILE_SIZE * m_width + static_cast<size_t>(column) * TILE_SIZE * bandHeight) * 4;
+}
+
+void TiledImage::setMaxTextureSize(int size) {
+    if (size > 0) {
+        s_maxTextureSize = size;
+    }
+}
+
+int TiledImage::getMaxTextureSize() {
+    return s_maxTextureSize;
+}
+
+bool TiledImage::needsTiling(int width, int height) {
+    return width > s_maxTextureSize || height > s_maxTextureSize;
+}
+
+int TiledImage::uploadOverview(NVGcontext* vg) {
+    if (m_overviewImage == -1 && m_overview && !m_released) {
+        m_overviewImage = nvgCreateImageRGBA(vg, m_overviewWidth, m_overviewHeight, NVG_IMAGE_GENERATE_MIPMAPS, m_overview);
+        // 概览图已在显存中，释放内存中的副本
+        if (m_overviewImage != -1) {
+            FreeImage(m_overview, "");
+        }
+    }
+    return m_overviewImage;
+}
+
+int TiledImage::uploadTile(NVGcontext* vg, int column, int row) {
+    int tileX = column * TILE_SIZE;
+    int tileY = row * TILE_SIZE;
+    int tileWidth = std::min(TILE_SIZE, m_width - tileX);
+    int tileHeight = std::min(TILE_SIZE, m_height - tileY);
+
+    if (m_spill.isOpen()) {
+        // 临时文件中的图块是连续的，直接上传
+        return nvgCreateImageRGBA(vg, tileWidth, tileHeight, 0, m_spill.data() + tileOffset(column, row));
+    }
+    // 从整幅图像中拷贝出连续的图块数据
+    m_scratch.resize(static_cast<size_t>(TILE_SIZE) * TILE_SIZE * 4);
+    size_t rowBytes = static_cast<size_t>(tileWidth) * 4;
+    for (int y = 0; y < tileHeight; ++y) {
+        const unsigned char* src = m_data + ((static_cast<size_t>(tileY + y) * m_width) + tileX) * 4;
+        std::memcpy(m_scratch.data() + y * rowBytes, src, rowBytes);
+    }
+    return nvgCreateImageRGBA(vg, tileWidth, tileHeight, 0, m_scratch.data());
+}
+
+bool TiledImage::render(NVGcontext* vg, float x, float y, float w, float h, float viewportWidth, float viewportHeight) {
+    if (m_released || !isValid() || w <= 0 || h <= 0) return true;
+    ++m_frame;
+
+    // 视口四角映射回图像坐标，得到可见范围
+    float xform[6], inverse[6];
+    nvgCurrentTransform(vg, xform);
+    if (!nvgTransformInverse(inverse, xform)) return true;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    const float corners[4][2] = {{0, 0}, {viewportWidth, 0}, {0, viewportHeight}, {viewportWidth, viewportHeight}};
+    for (const auto& corner : corners) {
+        float localX, localY;
+        nvgTransformPoint(&localX, &localY, inverse, corner[0], corner[1]);
+        minX = std::min(minX, localX);
+        minY = std::min(minY, localY);
+        maxX = std::max(maxX, localX);
+        maxY = std::max(maxY, localY);
+    }
+
+    if (maxX < x || maxY < y || minX > x + w || minY > y + h) return true;
+    float pixelScaleX = m_width / w;
+    float pixelScaleY = m_height / h;
+    auto tileIndex = [](float pixel, int count) {
+        return std::clamp(static_cast<int>(pixel / TILE_SIZE), 0, count - 1);
+    };
+    int firstColumn = tileIndex(std::max(0.0f, (minX - x) * pixelScaleX), m_columns);
+    int lastColumn = tileIndex(std::min(static_cast<float>(m_width), (maxX - x) * pixelScaleX), m_columns);
+    int firstRow = tileIndex(std::max(0.0f, (minY - y) * pixelScaleY), m_rows);
+    int lastRow = tileIndex(std::min(static_cast<float>(m_height), (maxY - y) * pixelScaleY), m_rows);
+
+    bool complete = true;
+    int uploads = 0;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            Tile& tile = m_tiles[static_cast<size_t>(row) * m_columns + column];
+            if (tile.image == -1) {
+                // 限制每帧上传数量，未上传的图块暂时由概览图代替
+                if (uploads >= MAX_UPLOADS_PER_FRAME) {
+                    complete = false;
+                    continue;
+                }
+                tile.image = uploadTile(vg, column, row);
+                ++uploads;
+                if (tile.image == -1) continue;
+                ++m_residentTiles;
+            }
+            tile.lastUsed = m_frame;
+
+            float tileX = x + column * TILE_SIZE / pixelScaleX;
+            float tileY = y + row * TILE_SIZE / pixelScaleY;
+            float tileW = std::min(TILE_SIZE, m_width - column * TILE_SIZE) / pixelScaleX;
+            float tileH = std::min(TILE_SIZE, m_height - row * TILE_SIZE) / pixelScaleY;
+            NVGpaint paint = nvgImagePattern(vg, tileX, tileY, tileW, tileH, 0, tile.image, 1.0f);
+            nvgBeginPath(vg);
+            nvgRect(vg, tileX, tileY, tileW, tileH);
+            nvgFillPaint(vg, paint);
+            nvgFill(vg);
+        }
+    }
+
+    evictTiles(vg);
+    return complete;
+}
+
+void TiledImage::evictTiles(NVGcontext* vg) {
+    if (m_residentTiles <= MAX_RESIDENT_TILES) return;
+
+    // 按最近使用时间淘汰，本帧可见的图块保留
+    std::vector<Tile*> candidates;
+    for (auto& tile : m_tiles) {
+        if (tile.image != -1 && tile.lastUsed != m_frame) {
+            candidates.push_back(&tile);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Tile* a, const Tile* b) {
+        return a->lastUsed < b->lastUsed;
+    });
+    for (Tile* tile : candidates) {
+        if (m_residentTiles <= MAX_RESIDENT_TILES) break;
+        nvgDeleteImage(vg, tile->image);
+        tile->image = -1;
+        --m_residentTiles;
+    }
+}
+
+void TiledImage::release(NVGcontext* vg) {
+    for (auto& tile : m_tiles) {
+        if (tile.image != -1) {
+            nvgDeleteImage(vg, tile.image);
+            tile.image = -1;
+        }
+    }
+    m_residentTiles = 0;
+    if (m_overviewImage != -1) {
+        nvgDeleteImage(vg, m_overviewImage);
+        m_overviewImage = -1;
+    }
+    m_released = true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+#include <nanovg.h>
+#include "../utils/MappedFile.h"
+
+class RowReader;
+
+/**
+ * @class TiledImage
+ * @brief 超过显卡最大纹理尺寸的大图
+ * @description 原图按固定尺寸切分成图块，每块是独立的 NanoVG 纹理，只上传与视口相交的图块；
+ *              缩小显示时使用一张概览图。像素按图块顺序写入缓存目录下的临时文件并映射，
+ *              每个图块在文件中连续存放，上传时由系统按需调入页面，不常驻内存。
+ *              支持按行解码的格式（JPEG）每次只解出一行图块，其他格式解码后整幅写出再释放
+ */
+class TiledImage {
+public:
+    static constexpr int TILE_SIZE = 512;
+    static constexpr int OVERVIEW_SIZE = 4096;     // 概览图长边
+    static constexpr int MAX_RESIDENT_TILES = 96;  // 常驻图块上限（约 96MB 显存）
+    static constexpr int MAX_UPLOADS_PER_FRAME = 6;
+
+    // 接管 data（RGBA，STBI_MALLOC 分配），在调用线程生成概览图并写出图块后释放 data；
+    // 临时文件无法写入时仍把 data 保留在内存中
+    TiledImage(unsigned char* data, int width, int height);
+    /**
+     * @brief 超过最大纹理尺寸且格式支持按行解码时直接分块解码，整幅像素不进内存
+     * @return 不需要分块、不支持按行解码或解码失败时返回 nullptr，由调用者完整解码
+     */
+    static std::shared_ptr<TiledImage> open(const MappedFile& file, const std::atomic<bool>* cancel = nullptr);
+    // 纹理需先在主线程调用 release 释放
+    ~TiledImage();
+    TiledImage(const TiledImage&) = delete;
+    TiledImage& operator=(const TiledImage&) = delete;
+
+    // 由窗口在创建 OpenGL 上下文后设置（GL_MAX_TEXTURE_SIZE）
+    static void setMaxTextureSize(int size);
+    static int getMaxTextureSize();
+    static bool needsTiling(int width, int height);
+
+    bool isValid() const { return m_data != nullptr || m_spill.isOpen(); }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getOverviewWidth() const { return m_overviewWidth; }
+    int getOverviewHeight() const { return m_overviewHeight; }
+    size_t getOverviewBytes() const { return static_cast<size_t>(m_overviewWidth) * m_overviewHeight * 4; }
+    static size_t getTileBudgetBytes() { return static_cast<size_t>(MAX_RESIDENT_TILES) * TILE_SIZE * TILE_SIZE * 4; }
+
+    // 上传概览图（主线程），纹理归 TiledImage 所有
+    int uploadOverview(NVGcontext* vg);
+
+    /**
+     * @brief 绘制与视口相交的图块
+     * @param x,y,w,h 整幅图像在当前坐标系下的位置
+     * @param viewportWidth,viewportHeight 视口尺寸（屏幕坐标）
+     * @return 可见图块是否都已上传，未完成时需要下一帧继续绘制
+     */
+    bool render(NVGcontext* vg, float x, float y, float w, float h, float viewportWidth, float viewportHeight);
+
+    // 释放全部纹理，之后不再绘制
+    void release(NVGcontext* vg);
+
+private:
+    struct Tile {
+        int image = -1;
+        uint64_t lastUsed = 0;
+    };
+
+    unsigned char* m_data = nullptr;    // 未写入临时文件时的整幅像素
+    MappedFile m_spill;                 // 按图块顺序存放的像素
+    std::filesystem::path m_spillPath;
+    int m_width = 0;
+    int m_height = 0;
+    int m_columns = 0;
+    int m_rows = 0;
+    std::vector<Tile> m_tiles;
+    int m_residentTiles = 0;
+    uint64_t m_frame = 0;
+    bool m_released = false;
+    std::vector<unsigned char> m_scratch; // 拷贝单个图块的缓冲区
+
+    unsigned char* m_overview = nullptr;
+    int m_overviewWidth = 0;
+    int m_overviewHeight = 0;
+    int m_overviewImage = -1;
+
+    static int s_maxTextureSize;
+
+    TiledImage(int width, int height);
+    void computeOverviewSize();
+    bool createSpillFile(std::ofstream& output);
+    // 写出一行图块（band 为 bandHeight 行整幅宽度的像素）
+    bool writeBand(std::ofstream& output, const unsigned char* band, int bandHeight);
+    bool mapSpillFile();
+    void removeSpillFile();
+    size_t tileOffset(int column, int row) const;
+    int uploadTile(NVGcontext* vg, int column, int row);
+    void evictTiles(NVGcontext* vg);
+};
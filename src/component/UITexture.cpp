@@ -15,13 +15,12 @@ UITexture::UITexture(float x, float y, float width, float height, const std::str
     , m_alpha(1.0f)
     , m_OriginWidth(height)
     , m_needsLoad(!imagePath.empty())
-    , m_isGif(false)
+    , m_isAnimated(false)
     , m_currentFrame(0)
     // , m_frameTime(0.0)
-    , m_gifPlaying(true) {
+    , m_playing(true) {
     // 不在构造函数中加载图像，延迟到render时加载
     s_instances.push_back(this);
-    m_frameTextures.resize(0);
 }
 
 UITexture::~UITexture() {
@@ -99,17 +98,20 @@ void UITexture::render(NVGcontext* vg) {
     // 设置透明度（考虑动画透明度）
     nvgGlobalAlpha(vg, m_alpha * m_animationOpacity);
 
-    if(m_isGif){
-        bool is_cycle = true;
-        playGif(m_currentFrame,m_gifFramesCount,m_frameTimeAccumulator,m_deltaTime, m_gifDelays, is_cycle);
-        m_nvgImage = m_frameTextures[m_currentFrame];
+    if(m_isAnimated){
+        updateAnimationFrame(vg);
         m_paintValid= false;
    
     }
+    // 缩小显示时改用较小的层级，避免走样和缩放动画中的闪烁
+    int image = m_isAnimated ? m_nvgImage : selectLevelImage(renderW * m_animationScaleX);
+    if (image != imgPaint_cache.image) {
+        m_paintValid = false;
+    }
     if (!m_paintValid ) {
 
-        imgPaint_cache = nvgImagePattern(vg, renderX, renderY, renderW, renderH, 0, m_nvgImage, 1.0f);
-        if(!m_isGif){
+        imgPaint_cache = nvgImagePattern(vg, renderX, renderY, renderW, renderH, 0, image, 1.0f);
+        if(!m_isAnimated){
                 m_paintValid = true;  
         }
 
@@ -119,6 +121,13 @@ void UITexture::render(NVGcontext* vg) {
     nvgRoundedRect(vg, renderX, renderY, renderW, renderH, m_cornerRadius);
     nvgFillPaint(vg, imgPaint_cache);
     nvgFill(vg);
+
+    // 超大图放大到超过概览图分辨率时，在概览图上叠加可见范围内的原图图块
+    if (m_tiled && renderW * m_animationScaleX > m_tiled->getOverviewWidth()) {
+        if (!m_tiled->render(vg, renderX, renderY, renderW, renderH, (float)m_OriginWidth, (float)m_OriginHeight)) {
+            m_paintValid = false;
+        }
+    }
     
 
     nvgRestore(vg);
@@ -336,67 +345,65 @@ bool UITexture::loadImage(NVGcontext* vg, const std::string& imagePath) {
     // 使用 stb_image 加载图像
     int channels;
     Timer timer;
-        if(isGifPath(m_imagePath)){
-            //////////////////////////////////    GIF     ///////////////////////////////
-            m_isGif = true;
-            data = loadGifImage(m_imagePath,m_imageWidth, m_imageHeight , channels, m_gifFramesCount,m_gifDelays) ;
-
-            if (!data){
-                std::cerr << "Failed to load image: " << imagePath << std::endl;
-                // std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+        // 只打开一次文件，动画、分块和静态解码共用（网络文件只读入一次）
+        MappedFile file(imagePath);
+        // 按文件头判断是否为动画（GIF、APNG），动画只同步解码第一帧，后续帧在解码线程池中提前合成
+        m_animatedImage = AnimatedImage::open(file, m_framePixels, m_frameDelay);
+        if(m_animatedImage){
+            //////////////////////////////////    ANIMATION     ///////////////////////////////
+            m_isAnimated = true;
+            m_metadata = ImageMetadata();
+            m_imageWidth = m_animatedImage->getWidth();
+            m_imageHeight = m_animatedImage->getHeight();
+            channels = 4;
+
+            // 纹理数量与帧数无关，后续帧只更新变化的区域
+            m_nvgImage = nvgCreateImageRGBA(vg, m_imageWidth, m_imageHeight, 0, m_framePixels.data());
+            if (m_nvgImage == -1) {
+                m_animatedImage.reset();
                 m_isLoadError = true;
                 return false;
             }
-           
-            try {
-                // 为每一帧创建纹理
-                for (int i = 0; i < m_gifFramesCount; i++) {
-                    // 计算当前帧的数据指针
-                    size_t frameSize = m_imageWidth * m_imageHeight * channels;
-                    unsigned char* frameData = data + (i * frameSize);
-                    
-                    // 创建当前帧的NanoVG纹理
-                    int textureId = nvgCreateImageRGBA(vg, m_imageWidth, m_imageHeight, 0, frameData);
-                    
-                    if (textureId == -1) {
-                        std::cerr << "Failed to create texture for frame " << i << std::endl;
-                    }
-                    m_frameTextures.push_back(textureId);
-                    // std::cout << "Preloaded frame " << i << " with texture ID: " << textureId << std::endl;
-                }
-                FreeImage(data,imagePath);
-                std::cout << "Successfully preloaded " << m_frameTextures.size() << " frames" << std::endl;
-                { 
-                    // for(auto it :m_gifDelays){
-                    //     std::cout << " delay: " << it << std::endl;
-                    // }
-                }
-                m_currentFrame = 0;
-                m_nvgImage = m_frameTextures[m_currentFrame];
-                // 释放 stb_image 分配的内存
-                 
-                FreeImage(data,imagePath); 
-                m_frameTimeAccumulator =0;
-            } catch (const std::exception& e) {
-                std::cerr << "Exception during frame preloading: " << e.what() << std::endl;
-                // clearFrameTextures(vg);
-                FreeImage(data,imagePath); 
-                return false;
-            }
+            m_currentFrame = 0;
+            m_frameTimeAccumulator =0;
         }else{
-            /////////////////////////////     NO GIF    ///////////////////////////////////////////
+            /////////////////////////////     STATIC    ///////////////////////////////////////////
             try {
-                m_isGif = false;
-                data = LoadImage(imagePath.c_str(), m_imageWidth,m_imageHeight,  channels);
-                    if (!data){
-                        std::cerr << "Failed to load image: " << imagePath << std::endl;
-                        // std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
-                        m_isLoadError = true;
-                        return false;
+                m_isAnimated = false;
+                // 可按行解码的超大图直接分块写入临时文件，不整幅解码到内存
+                m_tiled = TiledImage::open(file);
+                if (m_tiled) {
+                    m_imageWidth = m_tiled->getWidth();
+                    m_imageHeight = m_tiled->getHeight();
+                    channels = 4;
+                    m_metadata = ReadImageMetadata(file);
+                    m_nvgImage = m_tiled->uploadOverview(vg);
+                } else {
+                    // 一次打开文件，同时得到像素和 EXIF 元数据
+                    // 走到这里的 APNG 无法播放（帧信息损坏等），退回显示默认图像
+                    ImageLoadResult loaded = OpenImage(file, imagePath, 4, nullptr, true);
+                    data = loaded.pixels;
+                    m_imageWidth = loaded.width;
+                    m_imageHeight = loaded.height;
+                    channels = loaded.channels;
+                    m_metadata = loaded.metadata;
+                        if (!data){
+                            std::cerr << "Failed to load image: " << imagePath << std::endl;
+                            // std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+                            m_isLoadError = true;
+                            return false;
+                        }
+                    if (TiledImage::needsTiling(m_imageWidth, m_imageHeight)) {
+                        // 超过显卡最大纹理尺寸，分块显示，像素数据交由 TiledImage 管理
+                        m_tiled = std::make_shared<TiledImage>(data, m_imageWidth, m_imageHeight);
+                        data = nullptr;
+                        m_nvgImage = m_tiled->uploadOverview(vg);
+                    } else {
+                        // 创建 NanoVG 图像，由 GPU 生成 mipmap 以便缩小显示
+                        m_nvgImage = nvgCreateImageRGBA(vg, m_imageWidth, m_imageHeight, NVG_IMAGE_GENERATE_MIPMAPS, data);
                     }
-                // 创建 NanoVG 图像
-                m_nvgImage = nvgCreateImageRGBA(vg, m_imageWidth, m_imageHeight, 0, data);
                 
+                }
                 // 释放 stb_image 分配的内存
                 FreeImage(data,imagePath); 
             }catch (const std::exception& e) {
@@ -426,26 +433,47 @@ bool UITexture::loadImage(NVGcontext* vg, const std::string& imagePath) {
     return true;
 } 
 
-// 添加清理GIF帧纹理的实现
-void UITexture::clearFrameTextures(NVGcontext* vg) {
-    if (vg) {
-        for (int textureId : m_frameTextures) {
-            if (textureId != -1) {
-                nvgDeleteImage(vg, textureId);
-                // std::cout << "Deleted frame texture ID: " << textureId << std::endl;
-            }
-        }
+void UITexture::updateAnimationFrame(NVGcontext* vg) {
+    if (!m_animatedImage || !m_playing || m_nvgImage == -1) return;
+    m_frameTimeAccumulator += m_deltaTime * 1000.0;
+    if (m_frameTimeAccumulator < m_frameDelay) return;
+
+    // 下一帧还没合成好时停在当前帧，不跳帧（跳帧会漏掉中间帧的变化区域）
+    int delay = 0, index = 0;
+    FrameRect changed;
+    if (!m_animatedImage->nextFrame(m_framePixels, delay, index, changed)) return;
+    m_frameTimeAccumulator -= m_frameDelay;
+    // 卡顿（如拖动窗口）后不连续追帧
+    if (m_frameTimeAccumulator > delay) {
+        m_frameTimeAccumulator = 0;
     }
-    m_frameTextures.clear();
+    m_frameDelay = delay;
+    m_currentFrame = index;
+
+    if (changed.width <= 0 || changed.height <= 0) return;
+    // nvgUpdateImage 总是上传整张图，这里直接调用后端只上传变化的矩形，
+    // data 仍指向整帧起点，后端按纹理宽度跳过行列
+    NVGparams* params = nvgInternalParams(vg);
+    params->renderUpdateTexture(params->userPtr, m_nvgImage, changed.x, changed.y, changed.width, changed.height, m_framePixels.data());
 }
 
 void UITexture::unloadImage(NVGcontext* vg) {
 
     if (m_nvgImage != -1 && vg) {
-        clearFrameTextures(vg);
-        nvgDeleteImage(vg, m_nvgImage);
+        if (m_ownsImage && m_tiled) {
+            // 概览图纹理归 TiledImage 所有
+            m_tiled->release(vg);
+        } else if (m_ownsImage) {
+            nvgDeleteImage(vg, m_nvgImage);
+        }
         m_nvgImage = -1;
     }
+    m_animatedImage.reset();
+    m_framePixels.clear();
+    m_framePixels.shrink_to_fit();
+    m_tiled.reset();
+    m_levels.clear();
+    m_ownsImage = true;
     m_imageWidth = 0;
     m_imageHeight = 0;
 }
@@ -472,6 +500,33 @@ void UITexture::setImagePath(NVGcontext* vg, const std::string& imagePath) {
     }
 }
 
+void UITexture::setCachedImage(NVGcontext* vg, const std::string& imagePath, int nvgImage, int width, int height,
+                               const std::vector<TextureLevel>& levels, std::shared_ptr<TiledImage> tiled) {
+    unloadImage(vg);
+    m_imagePath = imagePath;
+    m_nvgImage = nvgImage;
+    m_levels = levels;
+    m_tiled = std::move(tiled);
+    m_metadata = ImageMetadata(); // 缓存纹理的元数据由 TextureCaches 保存
+    m_ownsImage = false;
+    m_imageWidth = width;
+    m_imageHeight = height;
+    m_isAnimated = false;
+    m_needsLoad = false;
+    m_isLoadError = false;
+    updateSize();
+    m_paintValid = false;
+}
+
+int UITexture::selectLevelImage(float screenWidth) const {
+    for (auto it = m_levels.rbegin(); it != m_levels.rend(); ++it) {
+        if (it->width >= screenWidth) {
+            return it->image;
+        }
+    }
+    return m_nvgImage;
+}
+
 void UITexture::calculateRenderBounds(float& renderX, float& renderY, 
                                      float& renderW, float& renderH) const {
     switch (m_scaleMode) {
@@ -3,7 +3,10 @@
 #include <string>
 #include <functional>
 #include <vector>
+#include <memory>
 #include "../utils/utils.h"
+#include "TiledImage.h"
+#include "../utils/AnimatedImage.h"
 /**
  * @class UITexture
  * @brief 纹理/图像控件类
@@ -48,9 +51,18 @@ public:
     int getImageWidth() const { return m_imageWidth; }
     int getImageHeight() const { return m_imageHeight; }
     bool isImageLoaded() const { return m_nvgImage != -1; }
+    int getImageHandle() const { return m_nvgImage; }
+    // loadImage 时与像素一起解析的元数据
+    const ImageMetadata& getMetadata() const { return m_metadata; }
+    // 当前显示的纹理来自 TextureCaches
+    bool isCachedImage() const { return m_nvgImage != -1 && !m_ownsImage; }
     
     // 添加带NVGcontext的版本，可以立即释放资源
     void setImagePath(NVGcontext* vg, const std::string& imagePath);
+    // 显示由 TextureCaches 预加载的纹理，纹理归缓存所有，不在此释放
+    // levels 为缩小显示时使用的金字塔层级（从大到小），tiled 为超大图的分块数据（nvgImage 为其概览图）
+    void setCachedImage(NVGcontext* vg, const std::string& imagePath, int nvgImage, int width, int height,
+                        const std::vector<TextureLevel>& levels = {}, std::shared_ptr<TiledImage> tiled = nullptr);
     
     // 添加静态清理方法
     static void cleanupAll(NVGcontext* vg);
@@ -86,21 +98,22 @@ public:
     bool isLoadError(){return m_isLoadError;}
 
 
-    // GIF动画相关方法
-    bool isGif() const { return m_isGif; }
-    // bool loadGifImage(NVGcontext* vg, const std::string& path);
-    void updateGifFrame(NVGcontext* vg); 
-    // GIF播放控制
-    // void playGif() { m_gifPlaying = true; }
-    // void pauseGif() { m_gifPlaying = false; }
-    void toggleGifPlayback() { m_gifPlaying = !m_gifPlaying; }
-    bool isGifPlaying() const { return m_gifPlaying; }
+    // 动画图像（GIF、APNG）相关方法
+    bool isAnimated() const { return m_isAnimated; }
+    void updateAnimationFrame(NVGcontext* vg);
+    // 动画播放控制
+    void togglePlayback() { m_playing = !m_playing; }
+    bool isPlaying() const { return m_playing; }
 
 
 private:
     // 基础纹理属性
     std::string m_imagePath;
     int m_nvgImage;          // NanoVG 图像句柄
+    bool m_ownsImage = true; // false 表示句柄来自纹理缓存
+    std::vector<TextureLevel> m_levels; // 缓存纹理的缩小层级，归缓存所有
+    std::shared_ptr<TiledImage> m_tiled; // 超过最大纹理尺寸的图像，m_nvgImage 为其概览图
+    ImageMetadata m_metadata;
     int m_imageWidth;
     int m_imageHeight;
     ScaleMode m_scaleMode;
@@ -135,18 +148,16 @@ private:
     bool m_isLoadError = false;
 
 
-    // GIF动画相关属性
-    bool m_isGif = false;
+    // 动画图像相关属性
+    bool m_isAnimated = false;
     int m_currentFrame = 0;
-    int m_gifFramesCount = 0;
-    std::vector<int> m_gifDelays;
+    int m_frameDelay = 100;               // 当前帧的显示时长（毫秒）
     double m_frameTimeAccumulator = 0.0;  // 当前帧时间累积器（毫秒）
     double m_deltaTime=0;
-    bool m_gifPlaying = true;
-    //存储每一帧的NanoVG纹理ID
-    std::vector<int> m_frameTextures;  // 每帧的纹理数组
-    // 添加清理GIF帧纹理
-    void clearFrameTextures(NVGcontext* vg);
+    bool m_playing = true;
+    // 帧由 AnimatedImage 在后台按播放顺序合成，只有一张纹理（m_nvgImage），每帧只上传变化的区域
+    std::unique_ptr<AnimatedImage> m_animatedImage;
+    std::vector<unsigned char> m_framePixels; // 最近取出的一帧，缓冲区与解码器交换复用
     // 事件回调
     DragCallback m_onDrag;
     ScrollCallback m_onScroll;
@@ -161,6 +172,8 @@ private:
     // 私有方法
     void calculateRenderBounds(float& renderX, float& renderY, 
                               float& renderW, float& renderH) const;
+    // 按屏幕上的显示宽度选择不小于它的最小层级
+    int selectLevelImage(float screenWidth) const;
 };
 
 
@@ -0,0 +1,186 @@
+#include "AnimatedImage.h"
+#include "ImageDecoder.h"
+#include <iostream>
+
+////////////////////////////////   GIF   ///////////////////////////////
+namespace {
+class GifSource : public AnimationSource {
+public:
+    explicit GifSource(GifFrameReader* reader) : m_reader(reader) {}
+    ~GifSource() override { CloseGifReader(m_reader); }
+
+    const char* name() const override { return "GIF"; }
+    int getWidth() const override { return m_width; }
+    int getHeight() const override { return m_height; }
+
+    const unsigned char* readFrame(int& delay, FrameRect& changed) override {
+        return ReadGifFrame(m_reader, m_width, m_height, delay, &changed);
+    }
+
+    void rewind() override { RewindGifReader(m_reader); }
+
+private:
+    GifFrameReader* m_reader;
+    // 画布尺寸在读出第一帧后才确定
+    int m_width = 0;
+    int m_height = 0;
+};
+}
+
+std::unique_ptr<AnimationSource> CreateGifSource(const unsigned char* data, size_t size) {
+    GifFrameReader* reader = OpenGifReader(data, size);
+    if (!reader) return nullptr;
+    return std::make_unique<GifSource>(reader);
+}
+
+////////////////////////////////   AnimatedImage   ///////////////////////////////
+AnimatedImage::~AnimatedImage() {
+    close();
+}
+
+int AnimatedImage::normalizeDelay(int delay) {
+    // 与浏览器一致，延时过小的帧按 100ms 播放
+    return delay <= 10 ? 100 : delay;
+}
+
+std::unique_ptr<AnimatedImage> AnimatedImage::open(MappedFile& file, std::vector<unsigned char>& firstFrame, int& delay) {
+    auto image = std::make_unique<AnimatedImage>();
+    if (!image->start(file, firstFrame, delay)) {
+        return nullptr;
+    }
+    return image;
+}
+
+bool AnimatedImage::start(MappedFile& file, std::vector<unsigned char>& firstFrame, int& delay) {
+    if (!file.isOpen()) return false;
+
+    // 按文件头选择来源，不是动画时交给静态图像的加载流程
+    MappedReadGuard guard(file);
+    std::unique_ptr<AnimationSource> source;
+    ImageFormat format = DetectImageFormat(file.data(), file.size());
+    if (format == ImageFormat::GIF) {
+        source = CreateGifSource(file.data(), file.size());
+    } else if (format == ImageFormat::PNG && IsAnimatedPng(file.data(), file.size())) {
+        source = CreateApngSource(file.data(), file.size());
+    }
+    if (!source) return false;
+
+    FrameRect changed;
+    const unsigned char* frame = source->readFrame(delay, changed);
+    if (!frame || guard.failed()) {
+        std::cerr << "Failed to load " << source->name() << std::endl;
+        return false;
+    }
+    m_width = source->getWidth();
+    m_height = source->getHeight();
+    firstFrame.assign(frame, frame + static_cast<size_t>(m_width) * m_height * 4);
+    delay = normalizeDelay(delay);
+    std::cout << source->name() << " width: " << m_width << ", height: " << m_height
+              << ", streaming " << RING_SIZE << " frames ahead" << std::endl;
+
+    // 来源引用的是映射中的数据，移动后地址不变
+    auto stream = std::make_shared<Stream>();
+    stream->file = std::move(file);
+    stream->source = std::move(source);
+    stream->frameBytes = firstFrame.size();
+    m_stream = std::move(stream);
+    scheduleComposition();
+    return true;
+}
+
+void AnimatedImage::close() {
+    if (!m_stream) return;
+    // 不等待合成任务：排队中的任务被丢弃，运行中的任务合成完当前帧后返回，由最后一个持有者释放映射
+    m_stream->cancel->store(true);
+    m_stream.reset();
+}
+
+bool AnimatedImage::nextFrame(std::vector<unsigned char>& pixels, int& delay, int& index, FrameRect& changed) {
+    if (!m_stream) return false;
+    bool available = false;
+    {
+        std::lock_guard<std::mutex> lock(m_stream->mutex);
+        if (!m_stream->ready.empty()) {
+            Frame& frame = m_stream->ready.front();
+            pixels.swap(frame.pixels);
+            delay = frame.delay;
+            index = frame.index;
+            changed = frame.changed;
+            if (!frame.pixels.empty()) {
+                m_stream->free.push_back(std::move(frame.pixels));
+            }
+            m_stream->ready.pop_front();
+            available = true;
+        }
+    }
+    // 腾出了位置，或上次提交时线程池队列已满，重新提交
+    scheduleComposition();
+    return available;
+}
+
+void AnimatedImage::scheduleComposition() {
+    std::shared_ptr<Stream> stream = m_stream;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (stream->composing || stream->finished || stream->ready.size() >= RING_SIZE) return;
+        stream->composing = true;
+    }
+    // 任务对象析构时（执行完毕，或被线程池丢弃/挤出队列）才允许提交下一个任务
+    std::shared_ptr<void> guard(nullptr, [stream](void*) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->composing = false;
+    });
+    // 优先级低于所有图片解码，线程池繁忙时动画暂停在当前帧
+    DecodePool::getInstance().submit([stream, guard]() {
+        composeFrames(*stream);
+    }, DecodePool::PRIORITY_BACKGROUND, stream->cancel);
+}
+
+void AnimatedImage::composeFrames(Stream& stream) {
+    while (!stream.cancel->load()) {
+        std::vector<unsigned char> buffer;
+        {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            if (stream.ready.size() >= RING_SIZE) return;
+            if (!stream.free.empty()) {
+                buffer = std::move(stream.free.back());
+                stream.free.pop_back();
+            }
+        }
+
+        // 合成在锁外进行，主线程取帧不受影响
+        int delay = 0;
+        FrameRect changed;
+        MappedReadGuard guard(stream.file);
+        const unsigned char* frame = stream.source->readFrame(delay, changed);
+        // 播放期间一直保持映射，文件被原地截断后停止解码，保留已显示的画面
+        if (guard.failed()) {
+            std::cerr << stream.source->name() << " file changed while playing, animation stopped" << std::endl;
+            if (stream.firstPass) stream.frameCount = stream.nextIndex;
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.finished = true;
+            return;
+        }
+        if (!frame) {
+            // 只有一帧或第一帧之后就出错时不再循环
+            if (stream.nextIndex <= 1) {
+                if (stream.firstPass) stream.frameCount = 1;
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                stream.finished = true;
+                return;
+            }
+            if (stream.firstPass) {
+                stream.frameCount = stream.nextIndex;
+                stream.firstPass = false;
+            }
+            stream.source->rewind();
+            stream.nextIndex = 0;
+            continue;
+        }
+
+        buffer.assign(frame, frame + stream.frameBytes);
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        stream.ready.push_back(Frame{std::move(buffer), normalizeDelay(delay), stream.nextIndex, changed});
+        ++stream.nextIndex;
+    }
+}
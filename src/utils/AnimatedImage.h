@@ -0,0 +1,111 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "MappedFile.h"
+#include "DecodePool.h"
+#include "utils.h"
+
+/**
+ * @class AnimationSource
+ * @brief 动画帧来源（GIF、APNG 等）
+ * @description 按播放顺序逐帧合成到内部画布，只保留合成下一帧所需的状态。
+ *              数据来自 AnimatedImage 持有的文件映射，读取期间保持有效
+ */
+class AnimationSource {
+public:
+    virtual ~AnimationSource() = default;
+    virtual const char* name() const = 0;
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+    /**
+     * @brief 合成下一帧
+     * @param delay 输出本帧显示时长（毫秒）
+     * @param changed 输出相对于上一帧变化的区域，每轮第一帧为整个画布
+     * @return RGBA 画布，下次调用前有效；最后一帧之后或出错时返回 nullptr
+     */
+    virtual const unsigned char* readFrame(int& delay, FrameRect& changed) = 0;
+    // 回到第一帧
+    virtual void rewind() = 0;
+};
+
+std::unique_ptr<AnimationSource> CreateGifSource(const unsigned char* data, size_t size);
+std::unique_ptr<AnimationSource> CreateApngSource(const unsigned char* data, size_t size);
+
+/**
+ * @class AnimatedImage
+ * @brief 流式播放动画图像
+ * @description 按播放顺序提前合成几帧放入环形队列，内存占用与帧数无关。
+ *              合成以低优先级、可取消的任务提交到 DecodePool，队列填满后任务结束，
+ *              取走帧腾出位置时再提交，不为每个动画单独创建线程。播放到最后一帧后从头开始继续解码
+ */
+class AnimatedImage {
+public:
+    static constexpr size_t RING_SIZE = 4; // 提前合成的帧数
+
+    AnimatedImage() = default;
+    ~AnimatedImage();
+    AnimatedImage(const AnimatedImage&) = delete;
+    AnimatedImage& operator=(const AnimatedImage&) = delete;
+
+    /**
+     * @brief 文件是动画格式（GIF 或 APNG）时同步解码第一帧（RGBA）并开始在后台合成后续帧
+     * @param file 成功时由 AnimatedImage 接管；返回 nullptr 时保持不变，可继续按静态图像解码
+     */
+    static std::unique_ptr<AnimatedImage> open(MappedFile& file, std::vector<unsigned char>& firstFrame, int& delay);
+    void close();
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    // 第一轮解码结束前返回 0
+    int getFrameCount() const { return m_stream ? m_stream->frameCount.load() : 0; }
+
+    /**
+     * @brief 取出下一帧（主线程）
+     * @param pixels 与队列中的帧交换缓冲区，原有的缓冲区留给合成任务复用
+     * @param changed 与上一帧相比变化的区域，只需上传这部分
+     * @return 下一帧还没合成好或只有一帧时返回 false
+     */
+    bool nextFrame(std::vector<unsigned char>& pixels, int& delay, int& index, FrameRect& changed);
+
+private:
+    struct Frame {
+        std::vector<unsigned char> pixels;
+        int delay = 0;
+        int index = 0;
+        FrameRect changed; // 相对于前一帧（播放顺序）变化的区域
+    };
+
+    // 解码状态由合成任务共同持有，关闭时任务仍在排队或运行也不会访问已释放的对象
+    struct Stream {
+        MappedFile file;
+        std::unique_ptr<AnimationSource> source;
+        size_t frameBytes = 0;
+        std::atomic<int> frameCount{0};
+        DecodePool::CancelFlag cancel = DecodePool::makeCancelFlag();
+
+        // 同一时刻只有一个合成任务，以下两项只由任务访问
+        int nextIndex = 1; // 第一帧已在 start 中解码
+        bool firstPass = true;
+
+        std::mutex mutex;
+        std::deque<Frame> ready;                     // 已合成、等待显示的帧
+        std::vector<std::vector<unsigned char>> free; // 可复用的帧缓冲区
+        bool composing = false;                      // 已有合成任务在排队或运行
+        bool finished = false;                       // 只有一帧或文件出错，不再合成
+    };
+
+    bool start(MappedFile& file, std::vector<unsigned char>& firstFrame, int& delay);
+    // 队列有空位且没有合成任务时提交一个（主线程）
+    void scheduleComposition();
+    // 合成任务：填满队列后返回
+    static void composeFrames(Stream& stream);
+    static int normalizeDelay(int delay);
+
+    int m_width = 0;
+    int m_height = 0;
+    std::shared_ptr<Stream> m_stream;
+};
@@ -0,0 +1,279 @@
+#include "AnimatedImage.h"
+#include "ImageDecoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+const unsigned char PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+// 与 utils.cpp 中 stb_image 的 STBI_MAX_DIMENSIONS 一致
+constexpr int MAX_DIMENSION = 32768;
+// 画布上限 1 GB，文件头中的尺寸不可信，分配前检查
+constexpr size_t MAX_CANVAS_BYTES = size_t(1) << 30;
+
+uint32_t readBE32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+uint16_t readBE16(const unsigned char* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+void appendBE32(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0xFFFFFFFFu) {
+    static uint32_t table[256] = {0};
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+void appendChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t length) {
+    appendBE32(out, static_cast<uint32_t>(length));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + length);
+    appendBE32(out, crc32(out.data() + start, length + 4) ^ 0xFFFFFFFFu);
+}
+
+/**
+ * APNG：每帧由 fcTL 描述位置、延时和处置方式，像素数据在 IDAT/fdAT 中。
+ * 每帧的数据重新组装成独立的 PNG 交给解码器，再按 blend/dispose 合成到画布
+ */
+class ApngSource : public AnimationSource {
+public:
+    enum Dispose { DISPOSE_NONE = 0, DISPOSE_BACKGROUND = 1, DISPOSE_PREVIOUS = 2 };
+    enum Blend { BLEND_SOURCE = 0, BLEND_OVER = 1 };
+
+    struct Frame {
+        FrameRect rect;
+        int delay = 100;
+        int dispose = DISPOSE_NONE;
+        int blend = BLEND_SOURCE;
+        std::vector<std::pair<const unsigned char*, size_t>> data; // 压缩数据片段（fdAT 已去掉序号）
+    };
+
+    bool parse(const unsigned char* data, size_t size);
+
+    const char* name() const override { return "APNG"; }
+    int getWidth() const override { return m_width; }
+    int getHeight() const override { return m_height; }
+    const unsigned char* readFrame(int& delay, FrameRect& changed) override;
+    void rewind() override;
+
+private:
+    unsigned char* decodeFrame(const Frame& frame, int& width, int& height);
+    void fillRect(const FrameRect& rect, const unsigned char* source, size_t sourceStride);
+
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<unsigned char> m_header;  // IHDR 数据（13 字节）
+    std::vector<std::pair<std::string, std::vector<unsigned char>>> m_extraChunks; // PLTE、tRNS 等
+    std::vector<Frame> m_frames;
+
+    std::vector<unsigned char> m_canvas;
+    std::vector<unsigned char> m_saved; // DISPOSE_PREVIOUS 时保存的区域
+    std::vector<unsigned char> m_png;   // 组装单帧 PNG 的缓冲区
+    size_t m_next = 0;
+};
+
+bool ApngSource::parse(const unsigned char* data, size_t size) {
+    if (size < 8 || std::memcmp(data, PNG_SIGNATURE, 8) != 0) return false;
+    Frame* current = nullptr;
+    bool seenData = false;
+    size_t pos = 8;
+    while (pos + 12 <= size) {
+        size_t length = readBE32(data + pos);
+        const char* type = reinterpret_cast<const char*>(data + pos + 4);
+        const unsigned char* body = data + pos + 8;
+        if (length > size - pos - 12) break;
+
+        if (std::memcmp(type, "IHDR", 4) == 0 && length == 13) {
+            m_header.assign(body, body + length);
+            m_width = static_cast<int>(readBE32(body));
+            m_height = static_cast<int>(readBE32(body + 4));
+        } else if (std::memcmp(type, "fcTL", 4) == 0 && length >= 26) {
+            Frame frame;
+            frame.rect.width = static_cast<int>(readBE32(body + 4));
+            frame.rect.height = static_cast<int>(readBE32(body + 8));
+            frame.rect.x = static_cast<int>(readBE32(body + 12));
+            frame.rect.y = static_cast<int>(readBE32(body + 16));
+            uint16_t delayNumerator = readBE16(body + 20);
+            uint16_t delayDenominator = readBE16(body + 22);
+            frame.delay = delayNumerator * 1000 / (delayDenominator == 0 ? 100 : delayDenominator);
+            frame.dispose = body[24];
+            frame.blend = body[25];
+            m_frames.push_back(std::move(frame));
+            current = &m_frames.back();
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            // IDAT 之前没有 fcTL 时默认图像不属于动画
+            if (current && m_frames.size() == 1) current->data.emplace_back(body, length);
+            seenData = true;
+        } else if (std::memcmp(type, "fdAT", 4) == 0 && length > 4) {
+            if (current) current->data.emplace_back(body + 4, length - 4);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        } else if (!seenData && (std::memcmp(type, "PLTE", 4) == 0 || std::memcmp(type, "tRNS", 4) == 0)) {
+            m_extraChunks.emplace_back(std::string(type, 4), std::vector<unsigned char>(body, body + length));
+        }
+        pos += 12 + length;
+    }
+
+    if (m_header.empty() || m_width <= 0 || m_height <= 0 ||
+        m_width > MAX_DIMENSION || m_height > MAX_DIMENSION ||
+        static_cast<size_t>(m_width) * m_height * 4 > MAX_CANVAS_BYTES) {
+        return false;
+    }
+    // 去掉越界或没有数据的帧。先比较宽度再比较偏移，x + width 不会溢出
+    m_frames.erase(std::remove_if(m_frames.begin(), m_frames.end(), [this](const Frame& frame) {
+        const FrameRect& r = frame.rect;
+        return frame.data.empty() || r.width <= 0 || r.height <= 0 || r.x < 0 || r.y < 0 ||
+               r.width > m_width || r.x > m_width - r.width ||
+               r.height > m_height || r.y > m_height - r.height;
+    }), m_frames.end());
+    if (m_frames.empty()) return false;
+
+    // 第一帧的“恢复到前一状态”按清除处理
+    if (m_frames[0].dispose == DISPOSE_PREVIOUS) m_frames[0].dispose = DISPOSE_BACKGROUND;
+    rewind();
+    return true;
+}
+
+void ApngSource::rewind() {
+    m_canvas.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+    m_next = 0;
+}
+
+unsigned char* ApngSource::decodeFrame(const Frame& frame, int& width, int& height) {
+    // 组装独立的 PNG：签名 + 改写尺寸的 IHDR + 调色板等 + IDAT + IEND
+    m_png.clear();
+    m_png.insert(m_png.end(), PNG_SIGNATURE, PNG_SIGNATURE + 8);
+    std::vector<unsigned char> header = m_header;
+    for (int i = 0; i < 4; ++i) {
+        header[i] = static_cast<unsigned char>(frame.rect.width >> (24 - i * 8));
+        header[4 + i] = static_cast<unsigned char>(frame.rect.height >> (24 - i * 8));
+    }
+    appendChunk(m_png, "IHDR", header.data(), header.size());
+    for (const auto& chunk : m_extraChunks) {
+        appendChunk(m_png, chunk.first.c_str(), chunk.second.data(), chunk.second.size());
+    }
+    for (const auto& piece : frame.data) {
+        appendChunk(m_png, "IDAT", piece.first, piece.second);
+    }
+    appendChunk(m_png, "IEND", nullptr, 0);
+
+    int channels = 0;
+    return ImageDecoderRegistry::getInstance().decode(m_png.data(), m_png.size(), width, height, channels, 4);
+}
+
+void ApngSource::fillRect(const FrameRect& rect, const unsigned char* source, size_t sourceStride) {
+    size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+    for (int y = 0; y < rect.height; ++y) {
+        unsigned char* row = m_canvas.data() + (static_cast<size_t>(rect.y + y) * m_width + rect.x) * 4;
+        if (source) {
+            std::memcpy(row, source + y * sourceStride, rowBytes);
+        } else {
+            std::memset(row, 0, rowBytes);
+        }
+    }
+}
+
+const unsigned char* ApngSource::readFrame(int& delay, FrameRect& changed) {
+    if (m_next >= m_frames.size()) return nullptr;
+    const Frame& frame = m_frames[m_next];
+
+    // 先处置上一帧，变化区域包含被处置的区域
+    if (m_next == 0) {
+        changed = FrameRect{0, 0, m_width, m_height};
+    } else {
+        const Frame& previous = m_frames[m_next - 1];
+        if (previous.dispose == DISPOSE_BACKGROUND) {
+            fillRect(previous.rect, nullptr, 0);
+        } else if (previous.dispose == DISPOSE_PREVIOUS && !m_saved.empty()) {
+            fillRect(previous.rect, m_saved.data(), static_cast<size_t>(previous.rect.width) * 4);
+        }
+        int left = std::min(frame.rect.x, previous.rect.x);
+        int top = std::min(frame.rect.y, previous.rect.y);
+        int right = std::max(frame.rect.x + frame.rect.width, previous.rect.x + previous.rect.width);
+        int bottom = std::max(frame.rect.y + frame.rect.height, previous.rect.y + previous.rect.height);
+        changed = FrameRect{left, top, right - left, bottom - top};
+    }
+
+    // 绘制前保存本帧区域，下一帧开始时恢复
+    const FrameRect& rect = frame.rect;
+    size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+    if (frame.dispose == DISPOSE_PREVIOUS) {
+        m_saved.resize(rowBytes * rect.height);
+        for (int y = 0; y < rect.height; ++y) {
+            std::memcpy(m_saved.data() + y * rowBytes,
+                        m_canvas.data() + (static_cast<size_t>(rect.y + y) * m_width + rect.x) * 4, rowBytes);
+        }
+    }
+
+    int width = 0, height = 0;
+    unsigned char* pixels = decodeFrame(frame, width, height);
+    if (!pixels || width != rect.width || height != rect.height) {
+        std::cerr << "Failed to decode APNG frame " << m_next << std::endl;
+        FreeImage(pixels, "");
+        return nullptr;
+    }
+
+    if (frame.blend == BLEND_SOURCE) {
+        fillRect(rect, pixels, rowBytes);
+    } else {
+        // 非预乘 alpha 的 over 混合
+        for (int y = 0; y < rect.height; ++y) {
+            const unsigned char* src = pixels + y * rowBytes;
+            unsigned char* dst = m_canvas.data() + (static_cast<size_t>(rect.y + y) * m_width + rect.x) * 4;
+            for (int x = 0; x < rect.width; ++x, src += 4, dst += 4) {
+                int sa = src[3];
+                if (sa == 255) {
+                    std::memcpy(dst, src, 4);
+                } else if (sa != 0) {
+                    int da = dst[3] * (255 - sa) / 255;
+                    int outAlpha = sa + da;
+                    for (int c = 0; c < 3; ++c) {
+                        dst[c] = static_cast<unsigned char>((src[c] * sa + dst[c] * da) / outAlpha);
+                    }
+                    dst[3] = static_cast<unsigned char>(outAlpha);
+                }
+            }
+        }
+    }
+    FreeImage(pixels, "");
+
+    delay = frame.delay;
+    ++m_next;
+    return m_canvas.data();
+}
+}
+
+std::unique_ptr<AnimationSource> CreateApngSource(const unsigned char* data, size_t size) {
+    auto source = std::make_unique<ApngSource>();
+    try {
+        if (!source->parse(data, size)) {
+            std::cerr << "Invalid APNG" << std::endl;
+            return nullptr;
+        }
+    } catch (const std::bad_alloc&) {
+        // 在主线程打开，内存不足时按无法播放处理
+        std::cerr << "Not enough memory for APNG canvas" << std::endl;
+        return nullptr;
+    }
+    return source;
+}
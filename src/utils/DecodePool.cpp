@@ -0,0 +1,121 @@
+#include "DecodePool.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+thread_local int t_workerIndex = -1;
+}
+
+DecodePool& DecodePool::getInstance() {
+    static DecodePool instance;
+    return instance;
+}
+
+DecodePool::DecodePool() {
+    size_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+    // 排队任务不超过线程数，连续切换图片时积压的工作量始终能在一轮内完成
+    m_capacity = workerCount;
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&DecodePool::workerThreadFunc, this, static_cast<int>(i));
+    }
+    std::cout << "[DecodePool] Started " << workerCount << " decode threads" << std::endl;
+}
+
+DecodePool::~DecodePool() {
+    shutdown();
+}
+
+void DecodePool::removeCancelledJobs(std::vector<Job>& dropped) {
+    for (auto it = m_queue.begin(); it != m_queue.end();) {
+        if (it->isCancelled()) {
+            dropped.push_back(std::move(*it));
+            it = m_queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool DecodePool::submit(Task task, int priority, CancelFlag cancel) {
+    std::vector<Job> dropped; // 在锁外析构，任务捕获的对象可能需要加其他锁
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) {
+            return false;
+        }
+
+        Job job;
+        job.priority = priority;
+        job.sequence = m_nextSequence++;
+        job.task = std::move(task);
+        job.cancel = std::move(cancel);
+
+        removeCancelledJobs(dropped);
+        if (m_queue.size() >= m_capacity) {
+            auto lowest = std::max_element(m_queue.begin(), m_queue.end(),
+                [](const Job& a, const Job& b) { return a.runsBefore(b); });
+            if (!job.runsBefore(*lowest)) {
+                dropped.push_back(std::move(job));
+                return false;
+            }
+            dropped.push_back(std::move(*lowest));
+            m_queue.erase(lowest);
+        }
+        m_queue.push_back(std::move(job));
+    }
+    m_condition.notify_one();
+    return true;
+}
+
+bool DecodePool::hasCapacity() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t active = std::count_if(m_queue.begin(), m_queue.end(), [](const Job& job) { return !job.isCancelled(); });
+    return !m_stopping && active < m_capacity;
+}
+
+void DecodePool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) return;
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int DecodePool::currentWorkerIndex() {
+    return t_workerIndex;
+}
+
+void DecodePool::workerThreadFunc(int index) {
+    t_workerIndex = index;
+    while (true) {
+        Job job;
+        std::vector<Job> dropped;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+            removeCancelledJobs(dropped);
+            if (m_queue.empty()) {
+                if (m_stopping) break;
+                continue;
+            }
+            auto next = std::min_element(m_queue.begin(), m_queue.end(),
+                [](const Job& a, const Job& b) { return a.runsBefore(b); });
+            job = std::move(*next);
+            m_queue.erase(next);
+        }
+        dropped.clear();
+
+        try {
+            job.task();
+        } catch (const std::exception& e) {
+            std::cerr << "[DecodePool] Exception in decode task: " << e.what() << std::endl;
+        }
+    }
+}
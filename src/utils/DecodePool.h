@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class DecodePool
+ * @brief 全局图像解码线程池
+ * @description 每个CPU核心一个工作线程，任务队列有上限，
+ *              TextureCaches 的解码请求和动画的逐帧合成都提交到这里，避免为每个请求创建线程。
+ *              队列按优先级出队（数值越小越先执行），同优先级先进先出；
+ *              被取消的任务在出队前直接丢弃，不占用线程
+ */
+class DecodePool {
+public:
+    using Task = std::function<void()>;
+    // 取消标记：置为 true 后排队中的任务被丢弃，运行中的任务应自行检查并尽快返回
+    using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+    static constexpr int PRIORITY_VISIBLE = 0;     // 当前显示的图片
+    static constexpr int PRIORITY_BACKGROUND = 100; // 无特定顺序的后台任务
+
+    static DecodePool& getInstance();
+    static CancelFlag makeCancelFlag() { return std::make_shared<std::atomic<bool>>(false); }
+
+    // 提交解码任务。队列已满时，若新任务优先级高于队列中最低优先级的任务则将其挤出，
+    // 否则返回 false。被丢弃的任务对象会在锁外析构，不会被执行
+    bool submit(Task task, int priority = PRIORITY_BACKGROUND, CancelFlag cancel = nullptr);
+
+    size_t getWorkerCount() const { return m_workers.size(); }
+    // 当前线程在池中的序号，不是工作线程时返回 -1
+    static int currentWorkerIndex();
+    size_t getQueueCapacity() const { return m_capacity; }
+    // 队列是否还有空位（仅作参考，提交时仍可能被拒绝）
+    bool hasCapacity();
+
+    // 停止接收任务，执行完队列中剩余任务后退出所有线程
+    void shutdown();
+
+private:
+    struct Job {
+        int priority = PRIORITY_BACKGROUND;
+        uint64_t sequence = 0;
+        Task task;
+        CancelFlag cancel;
+
+        bool isCancelled() const { return cancel && cancel->load(); }
+        bool runsBefore(const Job& other) const {
+            return priority != other.priority ? priority < other.priority : sequence < other.sequence;
+        }
+    };
+
+    DecodePool();
+    ~DecodePool();
+    DecodePool(const DecodePool&) = delete;
+    DecodePool& operator=(const DecodePool&) = delete;
+
+    void workerThreadFunc(int index);
+    // 把已取消的任务移到 dropped 中（调用者持有 m_mutex）
+    void removeCancelledJobs(std::vector<Job>& dropped);
+
+    std::vector<std::thread> m_workers;
+    std::vector<Job> m_queue; // 队列很短（不超过线程数），线性查找即可
+    size_t m_capacity = 0;
+    uint64_t m_nextSequence = 0;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
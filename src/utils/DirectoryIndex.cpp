@@ -0,0 +1,352 @@
+#include "DirectoryIndex.h"
+#include "utils.h"
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const char INDEX_MAGIC[4] = {'V', 'D', 'X', '2'};
+
+// 修改时间在这之内的目录不记录：同一时间刻度内可能还有未列出的变化
+constexpr int64_t RECENT_SECONDS = 2;
+
+// FNV-1a 64 位哈希
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int64_t toTicks(fs::file_time_type time) {
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// 索引文件按本机字节序写入，只在本机读取
+class Writer {
+public:
+    template <typename T>
+    void put(T value) {
+        m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    void putBytes(const void* data, size_t size) {
+        m_buffer.append(static_cast<const char*>(data), size);
+    }
+    void putString(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        m_buffer.append(value);
+    }
+    const std::string& buffer() const { return m_buffer; }
+
+private:
+    std::string m_buffer;
+};
+
+class Reader {
+public:
+    Reader(const std::vector<char>& data) : m_data(data) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (m_data.size() - m_offset < sizeof(value)) return false;
+        std::memcpy(&value, m_data.data() + m_offset, sizeof(value));
+        m_offset += sizeof(value);
+        return true;
+    }
+    bool getString(std::string& value) {
+        uint32_t size = 0;
+        if (!get(size) || m_data.size() - m_offset < size) return false;
+        value.assign(m_data.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+    // 数量字段的合理性检查，防止损坏的文件导致巨大的分配
+    bool getCount(uint32_t& count) {
+        return get(count) && count <= m_data.size() - m_offset;
+    }
+
+private:
+    const std::vector<char>& m_data;
+    size_t m_offset = 0;
+};
+}
+
+void DirectoryIndex::open(const fs::path& root, bool persistent) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_root = root;
+    m_persistent = persistent;
+    m_dirty = false;
+    m_directories.clear();
+    if (m_persistent && load()) {
+        std::cout << "[DirectoryIndex] Loaded " << m_directories.size() << " directories for " << m_root << std::endl;
+    }
+}
+
+std::string DirectoryIndex::makeKey(const fs::path& directory) const {
+    return directory.lexically_relative(m_root).generic_u8string();
+}
+
+std::string DirectoryIndex::absoluteRoot() const {
+    std::error_code ec;
+    return fs::absolute(m_root, ec).lexically_normal().generic_u8string();
+}
+
+fs::path DirectoryIndex::makeIndexPath() const {
+    std::string rootString = absoluteRoot();
+    uint64_t hash = hashBytes(14695981039346656037ull, rootString.data(), rootString.size());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vdx", static_cast<unsigned long long>(hash));
+    return getCacheDirectory("index") / name;
+}
+
+bool DirectoryIndex::lookup(const fs::path& directory, int64_t& modified,
+                            std::vector<FileRecord>& files, std::vector<std::string>& subdirectories) {
+    std::error_code ec;
+    auto time = fs::last_write_time(directory, ec);
+    modified = ec ? 0 : toTicks(time);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_directories.find(makeKey(directory));
+    if (it == m_directories.end() || it->second.modified == 0 || it->second.modified != modified) {
+        return false;
+    }
+    it->second.visited = true;
+    files = it->second.files;
+    subdirectories = it->second.subdirectories;
+    return true;
+}
+
+void DirectoryIndex::store(const fs::path& directory, int64_t modified,
+                           std::vector<FileRecord> files, std::vector<std::string> subdirectories) {
+    if (modified > toTicks(fs::file_time_type::clock::now() - std::chrono::seconds(RECENT_SECONDS))) {
+        modified = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DirectoryRecord& record = m_directories[makeKey(directory)];
+    // 保留未变化图片的尺寸和文件头信息，按名称查找原记录
+    buildFileIndex(record);
+    for (auto& file : files) {
+        auto found = record.fileIndex.find(file.name);
+        if (found == record.fileIndex.end()) continue;
+        const FileRecord& old = record.files[found->second];
+        if (old.size == file.size && old.modified == file.modified) {
+            file.width = old.width;
+            file.height = old.height;
+            file.headerRead = old.headerRead;
+            file.orientation = old.orientation;
+            file.captureTime = old.captureTime;
+        }
+    }
+    record.modified = modified;
+    record.files = std::move(files);
+    record.fileIndex.clear();
+    record.subdirectories = std::move(subdirectories);
+    record.visited = true;
+    m_dirty = true;
+}
+
+void DirectoryIndex::invalidate(const fs::path& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_directories.find(makeKey(directory));
+    if (it != m_directories.end() && it->second.modified != 0) {
+        it->second.modified = 0;
+        m_dirty = true;
+    }
+}
+
+void DirectoryIndex::setDimensions(const fs::path& path, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FileRecord* file = findFile(path);
+    if (file && (file->width != width || file->height != height)) {
+        file->width = width;
+        file->height = height;
+        m_dirty = true;
+    }
+}
+
+void DirectoryIndex::setHeaderInfo(const fs::path& path, uint64_t size, int64_t modified,
+                                   int width, int height, int orientation, int64_t captureTime) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FileRecord* file = findFile(path);
+    if (!file) return;
+    if (file->size != size || file->modified != modified) {
+        file->size = size;
+        file->modified = modified;
+        file->width = 0;
+        file->height = 0;
+    }
+    if (width > 0 && height > 0) {
+        file->width = width;
+        file->height = height;
+    }
+    file->headerRead = true;
+    file->orientation = orientation;
+    file->captureTime = captureTime;
+    m_dirty = true;
+}
+
+void DirectoryIndex::buildFileIndex(DirectoryRecord& record) {
+    // 逐个查找整个目录的文件时，按名称的线性查找会变成平方复杂度
+    if (record.fileIndex.size() == record.files.size()) return;
+    record.fileIndex.clear();
+    record.fileIndex.reserve(record.files.size());
+    for (size_t i = 0; i < record.files.size(); ++i) {
+        record.fileIndex.emplace(record.files[i].name, i);
+    }
+}
+
+DirectoryIndex::FileRecord* DirectoryIndex::findFile(const fs::path& path) {
+    auto it = m_directories.find(makeKey(path.parent_path()));
+    if (it == m_directories.end()) return nullptr;
+    DirectoryRecord& record = it->second;
+    buildFileIndex(record);
+    auto file = record.fileIndex.find(path.filename().u8string());
+    return file == record.fileIndex.end() ? nullptr : &record.files[file->second];
+}
+
+std::vector<fs::path> DirectoryIndex::getDirectories() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<fs::path> directories;
+    directories.reserve(m_directories.size());
+    for (const auto& entry : m_directories) {
+        // 与扫描时拼出的路径形式一致，监视事件中的路径才能和图片列表比较
+        directories.push_back(entry.first == "." ? m_root : m_root / fs::u8path(entry.first));
+    }
+    return directories;
+}
+
+void DirectoryIndex::beginScan() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_directories) {
+        entry.second.visited = false;
+    }
+}
+
+void DirectoryIndex::finishScan() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_directories.begin(); it != m_directories.end();) {
+        if (!it->second.visited) {
+            it = m_directories.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool DirectoryIndex::load() {
+    std::ifstream input(makeIndexPath(), std::ios::binary);
+    if (!input) return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    Reader reader(data);
+    char magic[4];
+    std::string root;
+    uint32_t directoryCount = 0;
+    if (!reader.get(magic) || std::memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        !reader.getString(root) || root != absoluteRoot() ||
+        !reader.getCount(directoryCount)) {
+        return false;
+    }
+
+    // 全部读取成功后才替换，损坏的文件等同于没有索引
+    std::unordered_map<std::string, DirectoryRecord> directories;
+    for (uint32_t i = 0; i < directoryCount; ++i) {
+        std::string key;
+        DirectoryRecord record;
+        uint32_t subdirectoryCount = 0, fileCount = 0;
+        if (!reader.getString(key) || !reader.get(record.modified) || !reader.getCount(subdirectoryCount)) {
+            return false;
+        }
+        record.subdirectories.resize(subdirectoryCount);
+        for (auto& subdirectory : record.subdirectories) {
+            if (!reader.getString(subdirectory)) {
+                return false;
+            }
+        }
+        if (!reader.getCount(fileCount)) {
+            return false;
+        }
+        record.files.resize(fileCount);
+        for (auto& file : record.files) {
+            uint8_t headerRead = 0;
+            int32_t orientation = 0;
+            if (!reader.getString(file.name) || !reader.get(file.size) || !reader.get(file.modified) ||
+                !reader.get(file.width) || !reader.get(file.height) ||
+                !reader.get(headerRead) || !reader.get(orientation) || !reader.get(file.captureTime)) {
+                return false;
+            }
+            file.headerRead = headerRead != 0;
+            file.orientation = orientation;
+        }
+        directories.emplace(std::move(key), std::move(record));
+    }
+    m_directories = std::move(directories);
+    return true;
+}
+
+bool DirectoryIndex::save() {
+    Writer writer;
+    fs::path indexPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_persistent || !m_dirty) return true;
+        indexPath = makeIndexPath();
+
+        writer.putBytes(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        writer.putString(absoluteRoot());
+        writer.put(static_cast<uint32_t>(m_directories.size()));
+        for (const auto& entry : m_directories) {
+            const DirectoryRecord& record = entry.second;
+            writer.putString(entry.first);
+            writer.put(record.modified);
+            writer.put(static_cast<uint32_t>(record.subdirectories.size()));
+            for (const auto& subdirectory : record.subdirectories) {
+                writer.putString(subdirectory);
+            }
+            writer.put(static_cast<uint32_t>(record.files.size()));
+            for (const auto& file : record.files) {
+                writer.putString(file.name);
+                writer.put(file.size);
+                writer.put(file.modified);
+                writer.put(file.width);
+                writer.put(file.height);
+                writer.put(static_cast<uint8_t>(file.headerRead));
+                writer.put(static_cast<int32_t>(file.orientation));
+                writer.put(file.captureTime);
+            }
+        }
+        m_dirty = false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(indexPath.parent_path(), ec);
+    // 先写临时文件再改名，中途退出不会留下不完整的索引
+    fs::path tempPath = indexPath;
+    tempPath += ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        written = file && file.write(writer.buffer().data(), writer.buffer().size());
+    }
+    if (written) {
+        fs::rename(tempPath, indexPath, ec);
+    }
+    if (!written || ec) {
+        std::cerr << "[DirectoryIndex] Failed to write " << indexPath << std::endl;
+        fs::remove(tempPath, ec);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @class DirectoryIndex
+ * @brief 目录树中图片的索引，保存到缓存目录供下次打开时使用
+ * @description 每个子目录记录修改时间、子目录名和其中图片的大小、修改时间、尺寸。
+ *              目录中增删、改名文件都会更新目录的修改时间，所以再次扫描时
+ *              每个目录只需读取一次修改时间，未变化的目录直接使用记录，不再列出内容。
+ *              扫描线程和主线程都可以调用
+ */
+class DirectoryIndex {
+public:
+    struct FileRecord {
+        std::string name;       // UTF-8 文件名
+        uint64_t size = 0;
+        int64_t modified = 0;
+        int width = 0;          // 0 表示尚未读取
+        int height = 0;
+        bool headerRead = false; // 已读取文件头，下面两项有效
+        int orientation = 0;
+        int64_t captureTime = 0;
+    };
+
+    DirectoryIndex() = default;
+    DirectoryIndex(const DirectoryIndex&) = delete;
+    DirectoryIndex& operator=(const DirectoryIndex&) = delete;
+
+    /**
+     * @brief 打开 root 的索引
+     * @param persistent 为 true 时读取上次保存的记录，save() 写回磁盘
+     */
+    void open(const fs::path& root, bool persistent);
+    const fs::path& getRoot() const { return m_root; }
+
+    /**
+     * @brief 目录修改时间与记录一致时返回记录的图片和子目录
+     * @param modified 输出本次读取的目录修改时间，未命中时传给 store()
+     */
+    bool lookup(const fs::path& directory, int64_t& modified,
+                std::vector<FileRecord>& files, std::vector<std::string>& subdirectories);
+    // 保存重新列出的目录内容，同名且大小、修改时间未变的图片保留已知尺寸和文件头信息
+    void store(const fs::path& directory, int64_t modified,
+               std::vector<FileRecord> files, std::vector<std::string> subdirectories);
+    // 目录内容已变化，下次扫描时重新列出
+    void invalidate(const fs::path& directory);
+    void setDimensions(const fs::path& path, int width, int height);
+    /**
+     * @brief 记录后台读取的文件头信息，下次打开时不再读取
+     * @param size,modified 读取时文件的大小和修改时间，与记录不同（原地改写）时一并更新，原有尺寸作废
+     */
+    void setHeaderInfo(const fs::path& path, uint64_t size, int64_t modified,
+                       int width, int height, int orientation, int64_t captureTime);
+    // 所有已记录的目录
+    std::vector<fs::path> getDirectories();
+
+    // 一次完整扫描开始和结束，结束时删除扫描中没有遇到的目录（已被删除）
+    void beginScan();
+    void finishScan();
+    // 有变化时写入缓存目录
+    bool save();
+
+private:
+    struct DirectoryRecord {
+        int64_t modified = 0;   // 0 表示需要重新列出
+        std::vector<std::string> subdirectories;
+        std::vector<FileRecord> files;
+        bool visited = false;
+        std::unordered_map<std::string, size_t> fileIndex; // 文件名 -> files 中的位置，按需建立
+    };
+
+    std::string makeKey(const fs::path& directory) const;
+    // 调用者持有 m_mutex
+    FileRecord* findFile(const fs::path& path);
+    static void buildFileIndex(DirectoryRecord& record);
+    std::string absoluteRoot() const;
+    fs::path makeIndexPath() const;
+    bool load();
+
+    std::mutex m_mutex;
+    fs::path m_root;
+    bool m_persistent = false;
+    bool m_dirty = false;
+    std::unordered_map<std::string, DirectoryRecord> m_directories; // 键为相对 root 的路径
+};
@@ -0,0 +1,215 @@
+#include "DirectoryScanner.h"
+#include "utils.h"
+#include <algorithm>
+#include <iostream>
+
+DirectoryScanner::~DirectoryScanner() {
+    stop();
+}
+
+bool DirectoryScanner::start(const fs::path& root, BatchHandler onBatch, FinishHandler onFinished,
+                             DirectoryIndex* index) {
+    stop();
+
+    std::error_code ec;
+    if (!fs::exists(root, ec)) {
+        std::cerr << "错误：路径不存在 - " << root << std::endl;
+        return false;
+    }
+    if (!fs::is_directory(root, ec)) {
+        std::cerr << "错误：目标不是目录 - " << root << std::endl;
+        return false;
+    }
+
+    m_onBatch = std::move(onBatch);
+    m_onFinished = std::move(onFinished);
+    m_index = index;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = false;
+        m_directories.clear();
+        m_directories.push_back(root);
+        m_pendingDirectories = 1;
+    }
+    m_running = true;
+
+    // 扫描主要等待磁盘和网络，线程数不受 CPU 核心数限制太多
+    unsigned threadCount = std::min(MAX_THREADS, std::max(2u, std::thread::hardware_concurrency()));
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&DirectoryScanner::workerThreadFunc, this);
+    }
+    return true;
+}
+
+void DirectoryScanner::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_directories.clear();
+    }
+    m_condition.notify_all();
+    wait();
+    m_running = false;
+}
+
+void DirectoryScanner::wait() {
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+void DirectoryScanner::workerThreadFunc() {
+    while (true) {
+        fs::path directory;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] {
+                return m_stopping || !m_directories.empty() || m_pendingDirectories == 0;
+            });
+            if (m_stopping || m_directories.empty()) {
+                return;
+            }
+            directory = std::move(m_directories.front());
+            m_directories.pop_front();
+        }
+
+        Batch batch;
+        scanDirectory(directory, batch);
+        flush(batch);
+
+        bool finished = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            finished = --m_pendingDirectories == 0;
+        }
+        if (finished) {
+            // 唤醒其余线程退出
+            m_condition.notify_all();
+            m_running = false;
+            if (!m_stopping && m_onFinished) {
+                m_onFinished();
+            }
+        }
+    }
+}
+
+void DirectoryScanner::scanDirectory(const fs::path& directory, Batch& batch) {
+    int64_t modified = 0;
+    std::vector<DirectoryIndex::FileRecord> files;
+    std::vector<std::string> subdirectories;
+    if (m_index && m_index->lookup(directory, modified, files, subdirectories)) {
+        // 目录没有变化，不必列出内容
+        for (const auto& subdirectory : subdirectories) {
+            queueDirectory(directory / fs::u8path(subdirectory));
+        }
+        // 与 directory / name 的结果相同，只拼接一次目录部分
+        std::string prefix = (directory / "").u8string();
+        for (const auto& file : files) {
+            if (m_stopping) return;
+            addImage(batch, prefix + file.name, file);
+        }
+        return;
+    }
+
+    std::error_code ec;
+    fs::directory_iterator dirIter(directory, fs::directory_options::skip_permission_denied, ec);
+    if (ec) {
+        std::cerr << "跳过无法访问的目录: " << directory << " " << ec.message() << std::endl;
+        return;
+    }
+
+    bool complete = true;
+    for (fs::directory_iterator endIter; dirIter != endIter; dirIter.increment(ec)) {
+        if (ec) {
+            std::cerr << "跳过无法访问的文件: " << directory << " " << ec.message() << std::endl;
+            complete = false;
+            break;
+        }
+        if (m_stopping) return;
+
+        try {
+            const fs::directory_entry& entry = *dirIter;
+            // 类型来自目录项本身，大多数文件系统上不需要再查询文件状态
+            std::error_code typeError;
+            if (entry.is_directory(typeError)) {
+                if (!entry.is_symlink(typeError)) {
+                    if (m_index) {
+                        subdirectories.push_back(entry.path().filename().u8string());
+                    }
+                    queueDirectory(entry.path());
+                }
+                continue;
+            }
+            if (!entry.is_regular_file(typeError)) continue;
+            if (!hasImageExtension(entry.path())) continue;
+
+            // 大小和修改时间在这里取得一次，按这两项排序时不再读取文件状态；
+            // 使用索引时只有变化过的目录会走到这里
+            DirectoryIndex::FileRecord file;
+            file.size = entry.file_size(typeError);
+            file.modified = static_cast<int64_t>(entry.last_write_time(typeError).time_since_epoch().count());
+            addImage(batch, entry.path().u8string(), file);
+            if (m_index) {
+                file.name = entry.path().filename().u8string();
+                files.push_back(std::move(file));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "跳过无法访问的文件: " << e.what() << std::endl;
+            complete = false;
+        }
+    }
+
+    if (m_index && complete) {
+        m_index->store(directory, modified, std::move(files), std::move(subdirectories));
+    }
+}
+
+void DirectoryScanner::queueDirectory(fs::path directory) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_directories.push_back(std::move(directory));
+        ++m_pendingDirectories;
+    }
+    m_condition.notify_one();
+}
+
+void DirectoryScanner::addImage(Batch& batch, std::string_view utf8Path, const DirectoryIndex::FileRecord& file) {
+    size_t index = batch.addUtf8(utf8Path);
+    batch.setFileInfo(index, file.size, file.modified);
+    if (file.width > 0 && file.height > 0) {
+        batch.setDimensions(index, file.width, file.height);
+    }
+    // 上次已读取过文件头，不必再交给 MetadataHarvester
+    if (file.headerRead) {
+        batch.setOrientation(index, file.orientation);
+        batch.setCaptureTime(index, file.captureTime);
+    }
+    if (batch.size() >= BATCH_SIZE) {
+        flush(batch);
+    }
+}
+
+void DirectoryScanner::flush(Batch& batch) {
+    if (batch.empty() || m_stopping) return;
+    if (m_onBatch) {
+        m_onBatch(batch);
+    }
+    batch.clear();
+}
+
+void DirectoryScanner::scan(const fs::path& root, ImageCatalog& catalog, DirectoryIndex* index) {
+    catalog.clear();
+
+    std::mutex resultMutex;
+    DirectoryScanner scanner;
+    bool started = scanner.start(root, [&](Batch& batch) {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        catalog.append(batch);
+    }, nullptr, index);
+    if (!started) return;
+    scanner.wait();
+    catalog.sortByPath();
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <filesystem>
+#include "DirectoryIndex.h"
+#include "ImageCatalog.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * @class DirectoryScanner
+ * @brief 多线程递归查找目录中的图片
+ * @description 每个子目录是一个任务，几个扫描线程从共享队列中取目录，
+ *              遇到子目录放回队列，找到的图片按批次回调，不必等整个目录树扫描完。
+ *              只用目录项中已有的类型信息判断文件和目录，不再逐个查询文件状态。
+ *              与 recursive_directory_iterator 一样不进入指向目录的符号链接。
+ *              指定 DirectoryIndex 时，修改时间未变的目录直接使用索引中的记录
+ */
+class DirectoryScanner {
+public:
+    static constexpr size_t BATCH_SIZE = 512; // 单个目录文件很多时按此数量分批回调
+    static constexpr unsigned MAX_THREADS = 8;
+
+    // 一批图片，索引中已知的大小、修改时间、尺寸和文件头信息一并带出
+    using Batch = ImageCatalog;
+    // 在扫描线程中调用，可以取走 batch 中的数据
+    using BatchHandler = std::function<void(Batch& batch)>;
+    // 扫描全部完成时在最后一个扫描线程中调用，stop() 中止时不调用
+    using FinishHandler = std::function<void()>;
+
+    DirectoryScanner() = default;
+    ~DirectoryScanner();
+    DirectoryScanner(const DirectoryScanner&) = delete;
+    DirectoryScanner& operator=(const DirectoryScanner&) = delete;
+
+    // 开始扫描 root 及其子目录，上一次扫描未结束时先中止。index 须在扫描结束前保持有效
+    bool start(const fs::path& root, BatchHandler onBatch, FinishHandler onFinished = nullptr,
+               DirectoryIndex* index = nullptr);
+    // 中止扫描并等待扫描线程退出（不能在回调中调用）
+    void stop();
+    // 等待扫描完成
+    void wait();
+    bool isRunning() const { return m_running.load(); }
+
+    // 同步扫描，结果按路径排序
+    static void scan(const fs::path& root, ImageCatalog& catalog, DirectoryIndex* index = nullptr);
+
+private:
+    void workerThreadFunc();
+    void scanDirectory(const fs::path& directory, Batch& batch);
+    void queueDirectory(fs::path directory);
+    void addImage(Batch& batch, std::string_view utf8Path, const DirectoryIndex::FileRecord& file);
+    void flush(Batch& batch);
+
+    std::vector<std::thread> m_workers;
+    std::deque<fs::path> m_directories;
+    size_t m_pendingDirectories = 0; // 排队中和正在扫描的目录数，降为 0 时扫描结束
+    std::atomic<bool> m_stopping{false}; // 修改时持有 m_mutex，扫描中途可不加锁检查
+    std::atomic<bool> m_running{false};
+    BatchHandler m_onBatch;
+    FinishHandler m_onFinished;
+    DirectoryIndex* m_index = nullptr;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
@@ -0,0 +1,154 @@
+#include "DirectoryWatcher.h"
+#include "utils.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+DirectoryWatcher::~DirectoryWatcher() {
+    stop();
+}
+
+#if defined(__linux__)
+
+namespace {
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE |
+                                IN_CREATE | IN_ONLYDIR | IN_EXCL_UNLINK;
+}
+
+bool DirectoryWatcher::start() {
+    if (m_fd >= 0) return true;
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        std::cerr << "[DirectoryWatcher] inotify_init1 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    m_limitReported = false;
+    return true;
+}
+
+void DirectoryWatcher::stop() {
+    if (m_fd < 0) return;
+    close(m_fd);
+    m_fd = -1;
+    m_watches.clear();
+}
+
+bool DirectoryWatcher::watch(const fs::path& directory) {
+    if (m_fd < 0) return false;
+    int wd = inotify_add_watch(m_fd, directory.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        // 超出 max_user_watches 时只提示一次，已监视的目录照常工作
+        if (errno == ENOSPC && !m_limitReported) {
+            std::cerr << "[DirectoryWatcher] inotify watch limit reached, "
+                         "raise fs.inotify.max_user_watches to watch more directories" << std::endl;
+            m_limitReported = true;
+        }
+        return false;
+    }
+    // 同一目录再次添加时返回原描述符
+    m_watches[wd] = directory;
+    return true;
+}
+
+void DirectoryWatcher::poll(std::vector<Change>& changes) {
+    if (m_fd < 0) return;
+    alignas(inotify_event) char buffer[64 * 1024];
+    while (true) {
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) break; // EAGAIN：没有更多事件
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changes.push_back({Change::Overflow, fs::path()});
+                continue;
+            }
+            auto it = m_watches.find(event->wd);
+            if (it == m_watches.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                // 目录已删除或监视已移除
+                m_watches.erase(it);
+                continue;
+            }
+            if (event->len == 0) continue;
+            fs::path path = it->second / event->name;
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    watchTree(path, changes);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    unwatchTree(path);
+                    changes.push_back({Change::DirectoryRemoved, path});
+                }
+                continue;
+            }
+            if (!hasImageExtension(path)) continue;
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                changes.push_back({Change::Added, path});
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                changes.push_back({Change::Removed, path});
+            }
+        }
+    }
+}
+
+void DirectoryWatcher::watchTree(const fs::path& directory, std::vector<Change>& changes) {
+    // 先监视再列出，列出期间写完的文件可能报告两次，由调用者去重
+    if (!watch(directory)) return;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        std::error_code typeError;
+        if (it->is_directory(typeError)) {
+            if (!it->is_symlink(typeError)) {
+                watchTree(it->path(), changes);
+            }
+        } else if (it->is_regular_file(typeError) && hasImageExtension(it->path())) {
+            changes.push_back({Change::Added, it->path()});
+        }
+    }
+}
+
+void DirectoryWatcher::unwatchTree(const fs::path& directory) {
+    // 移出的目录仍然存在，监视要手动移除；删除的目录内核已自动移除
+    for (auto it = m_watches.begin(); it != m_watches.end();) {
+        auto relative = it->second.lexically_relative(directory);
+        if (!relative.empty() && *relative.begin() != "..") {
+            inotify_rm_watch(m_fd, it->first);
+            it = m_watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#else
+
+bool DirectoryWatcher::start() {
+    return false;
+}
+
+void DirectoryWatcher::stop() {
+}
+
+bool DirectoryWatcher::watch(const fs::path&) {
+    return false;
+}
+
+void DirectoryWatcher::poll(std::vector<Change>&) {
+}
+
+void DirectoryWatcher::watchTree(const fs::path&, std::vector<Change>&) {
+}
+
+void DirectoryWatcher::unwatchTree(const fs::path&) {
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @class DirectoryWatcher
+ * @brief 监视目录树中图片的增删（Linux 使用 inotify）
+ * @description 不创建线程，主线程每帧调用 poll() 以非阻塞方式取出变化。
+ *              文件写完（关闭写入或移入）后才报告新增，相机联机拍摄时不会读到写了一半的文件。
+ *              新建或移入的子目录自动加入监视，其中已有的图片作为新增报告。
+ *              其他平台上 start() 返回 false
+ */
+class DirectoryWatcher {
+public:
+    struct Change {
+        enum Type {
+            Added,              // 新图片（path 为文件）
+            Removed,            // 图片被删除或移出
+            DirectoryRemoved,   // 目录被删除或移出，其中的图片都已不在
+            Overflow            // 事件队列溢出，有变化丢失，需要重新扫描
+        };
+        Type type;
+        fs::path path;
+    };
+
+    DirectoryWatcher() = default;
+    ~DirectoryWatcher();
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    bool start();
+    void stop();
+    bool isActive() const { return m_fd >= 0; }
+    // 监视一个目录（不含子目录）
+    bool watch(const fs::path& directory);
+    // 取出上次调用以来的变化
+    void poll(std::vector<Change>& changes);
+
+private:
+    // 监视新目录及其子目录，把其中的图片作为新增报告
+    void watchTree(const fs::path& directory, std::vector<Change>& changes);
+    void unwatchTree(const fs::path& directory);
+
+    int m_fd = -1;
+    std::unordered_map<int, fs::path> m_watches; // 监视描述符 -> 目录
+    bool m_limitReported = false;
+};
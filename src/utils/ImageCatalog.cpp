@@ -0,0 +1,735 @@
+#include "ImageCatalog.h"
+#include <algorithm>
+#include <cctype>
+#include <array>
+#include <thread>
+
+namespace {
+constexpr uint32_t NO_POSITION = UINT32_MAX;
+// 已删除条目占用的字节超过这个值且超过一半时整理路径内存
+constexpr size_t COMPACT_MIN_GARBAGE = 1 << 20;
+// 条目少于这个数量时单线程排序，创建线程的开销比排序本身大
+constexpr size_t PARALLEL_SORT_MIN = 16 * 1024;
+constexpr unsigned MAX_SORT_THREADS = 8;
+// 前缀相同的条目不多于这个数量时直接比较完整文本
+constexpr size_t SMALL_TEXT_RUN = 32;
+
+const char* const SORT_MODE_NAMES[ImageCatalog::SORT_MODE_COUNT] = {
+    "path", "natural", "modified", "captured", "size", "dimensions"
+};
+
+bool isSeparator(char c) {
+    return c == '/' || c == static_cast<char>(fs::path::preferred_separator);
+}
+
+// 按扩展名猜测格式，读取文件头后可用 setFormat 修正
+ImageFormat formatFromPath(std::string_view utf8Path) {
+    size_t dot = utf8Path.find_last_of('.');
+    if (dot == std::string_view::npos) return ImageFormat::Unknown;
+    std::string ext(utf8Path.substr(dot + 1));
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (ext == "jpg" || ext == "jpeg") return ImageFormat::JPEG;
+    if (ext == "png") return ImageFormat::PNG;
+    if (ext == "gif") return ImageFormat::GIF;
+    if (ext == "bmp") return ImageFormat::BMP;
+    if (ext == "psd") return ImageFormat::PSD;
+    if (ext == "hdr") return ImageFormat::HDR;
+    return ImageFormat::Unknown;
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// 自然顺序的编码：逐字节比较编码结果即为自然顺序。
+// 分隔符编码为 1；连续数字去掉前导零后编码为 '0'、“1 + 位数”再接数字本身，
+// 数字串与其他字符的先后和单个数字相同，位数多的数值大；ASCII 字母转为小写
+void appendNaturalKey(std::string& out, std::string_view path) {
+    for (size_t i = 0; i < path.size();) {
+        char c = path[i];
+        if (isSeparator(c)) {
+            out.push_back(1);
+            ++i;
+        } else if (isDigit(c)) {
+            size_t begin = i;
+            while (begin < path.size() && path[begin] == '0') ++begin;
+            size_t end = begin;
+            while (end < path.size() && isDigit(path[end])) ++end;
+            out.push_back('0');
+            out.push_back(static_cast<char>(1 + std::min<size_t>(end - begin, 254)));
+            out.append(path.substr(begin, end - begin));
+            i = end;
+        } else {
+            out.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c);
+            ++i;
+        }
+    }
+}
+
+std::string_view tail(std::string_view text, size_t offset) {
+    return text.substr(std::min(offset, text.size()));
+}
+
+// 前 8 个字节按大端组成整数，整数的大小顺序与字节序列的字典序一致
+uint64_t packPrefix(std::string_view text, bool mapSeparators) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        unsigned char c = 0;
+        if (i < text.size()) {
+            c = static_cast<unsigned char>(text[i]);
+            if (mapSeparators && isSeparator(text[i])) c = 1;
+        }
+        prefix = (prefix << 8) | c;
+    }
+    return prefix;
+}
+
+// 把 [0, count) 分成若干段，在多个线程中执行 f(begin, end, part)
+template <typename Function>
+void parallelFor(size_t count, unsigned parts, Function f) {
+    std::vector<std::thread> threads;
+    for (unsigned part = 1; part < parts; ++part) {
+        threads.emplace_back(f, count * part / parts, count * (part + 1) / parts, part);
+    }
+    f(0, count / parts, 0u);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+}
+
+const char* ImageCatalog::sortModeName(SortMode mode) {
+    return SORT_MODE_NAMES[static_cast<int>(mode)];
+}
+
+ImageCatalog::SortMode ImageCatalog::sortModeFromName(const std::string& name) {
+    for (int i = 0; i < SORT_MODE_COUNT; ++i) {
+        if (name == SORT_MODE_NAMES[i]) return static_cast<SortMode>(i);
+    }
+    return SortMode::Path;
+}
+
+void ImageCatalog::clear() {
+    *this = ImageCatalog();
+}
+
+void ImageCatalog::reserve(size_t count) {
+    m_pathOffset.reserve(count);
+    m_pathLength.reserve(count);
+    m_hash.reserve(count);
+    m_fileSize.reserve(count);
+    m_modified.reserve(count);
+    m_captureTime.reserve(count);
+    m_width.reserve(count);
+    m_height.reserve(count);
+    m_orientation.reserve(count);
+    m_format.reserve(count);
+    m_position.reserve(count);
+    m_order.reserve(count);
+}
+
+size_t ImageCatalog::addUtf8(std::string_view utf8Path) {
+    uint32_t hash = hashPath(utf8Path);
+    size_t existing = findSlot(utf8Path, hash);
+    if (existing != npos) return m_position[existing];
+
+    uint32_t slot = allocateSlot(utf8Path, hash);
+    insertHash(slot);
+    m_position[slot] = static_cast<uint32_t>(m_order.size());
+    m_order.push_back(slot);
+    return m_order.size() - 1;
+}
+
+size_t ImageCatalog::insertSorted(const fs::path& path, uint64_t size, int64_t modified) {
+    std::string utf8Path = path.u8string();
+    uint32_t hash = hashPath(utf8Path);
+    size_t existing = findSlot(utf8Path, hash);
+    if (existing != npos) return m_position[existing];
+
+    uint32_t slot = allocateSlot(utf8Path, hash);
+    m_fileSize[slot] = size;
+    m_modified[slot] = modified;
+    size_t position;
+    if (m_sortMode == SortMode::Path) {
+        position = lowerBoundUtf8(utf8Path);
+    } else {
+        std::string arena, otherArena;
+        SortItem item = makeSortItem(slot, m_sortMode, 0, arena);
+        auto it = std::lower_bound(m_order.begin(), m_order.end(), item,
+            [&](uint32_t other, const SortItem& value) {
+                otherArena.clear();
+                return itemLess(makeSortItem(other, m_sortMode, 0, otherArena), value);
+            });
+        position = static_cast<size_t>(it - m_order.begin());
+    }
+    insertHash(slot);
+    m_order.insert(m_order.begin() + position, slot);
+    rebuildPositions(position);
+    return position;
+}
+
+size_t ImageCatalog::lowerBoundUtf8(std::string_view utf8Path) const {
+    auto it = std::lower_bound(m_order.begin(), m_order.end(), utf8Path,
+        [this](uint32_t slot, std::string_view value) { return pathLess(slotPath(slot), value); });
+    return static_cast<size_t>(it - m_order.begin());
+}
+
+void ImageCatalog::append(const ImageCatalog& other) {
+    for (size_t i = 0; i < other.size(); ++i) {
+        size_t previousSize = size();
+        size_t index = addUtf8(other.pathView(i));
+        if (size() == previousSize) continue; // 已存在
+
+        uint32_t slot = m_order[index];
+        uint32_t source = other.m_order[i];
+        m_fileSize[slot] = other.m_fileSize[source];
+        m_modified[slot] = other.m_modified[source];
+        m_captureTime[slot] = other.m_captureTime[source];
+        m_width[slot] = other.m_width[source];
+        m_height[slot] = other.m_height[source];
+        m_orientation[slot] = other.m_orientation[source];
+        m_format[slot] = other.m_format[source];
+    }
+}
+
+bool ImageCatalog::erase(const fs::path& path) {
+    std::string utf8Path = path.u8string();
+    size_t slot = findSlot(utf8Path, hashPath(utf8Path));
+    if (slot == npos) return false;
+    size_t position = m_position[slot];
+    m_order.erase(m_order.begin() + position);
+    rebuildPositions(position);
+    releaseSlot(static_cast<uint32_t>(slot));
+    compactIfNeeded();
+    return true;
+}
+
+size_t ImageCatalog::eraseDirectory(const fs::path& directory) {
+    std::string prefix = directory.u8string();
+    if (prefix.empty()) return 0;
+    bool endsWithSeparator = isSeparator(prefix.back());
+
+    size_t kept = 0;
+    size_t firstChanged = npos;
+    std::vector<uint32_t> removed;
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        uint32_t slot = m_order[i];
+        std::string_view path = slotPath(slot);
+        bool inside = path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0 &&
+                      (endsWithSeparator || isSeparator(path[prefix.size()]));
+        if (inside) {
+            m_position[slot] = NO_POSITION;
+            removed.push_back(slot);
+            if (firstChanged == npos) firstChanged = i;
+            continue;
+        }
+        m_order[kept++] = slot;
+    }
+    if (removed.empty()) return 0;
+
+    m_order.resize(kept);
+    rebuildPositions(firstChanged);
+    // 全部释放后再整理，整理时已删除的路径都计入了 m_garbageBytes
+    for (uint32_t slot : removed) {
+        releaseSlot(slot);
+    }
+    compactIfNeeded();
+    return removed.size();
+}
+
+size_t ImageCatalog::findUtf8(std::string_view utf8Path) const {
+    size_t slot = findSlot(utf8Path, hashPath(utf8Path));
+    return slot == npos ? npos : m_position[slot];
+}
+
+std::string_view ImageCatalog::pathView(size_t index) const {
+    return slotPath(m_order[index]);
+}
+
+std::string_view ImageCatalog::nameView(size_t index) const {
+    std::string_view path = pathView(index);
+    for (size_t i = path.size(); i > 0; --i) {
+        if (isSeparator(path[i - 1])) {
+            return path.substr(i);
+        }
+    }
+    return path;
+}
+
+void ImageCatalog::setFileInfo(size_t index, uint64_t size, int64_t modified) {
+    uint32_t slot = m_order[index];
+    m_fileSize[slot] = size;
+    m_modified[slot] = modified;
+}
+
+void ImageCatalog::setDimensions(size_t index, int width, int height) {
+    uint32_t slot = m_order[index];
+    m_width[slot] = static_cast<uint32_t>(std::max(0, width));
+    m_height[slot] = static_cast<uint32_t>(std::max(0, height));
+}
+
+void ImageCatalog::setOrientation(size_t index, int orientation) {
+    m_orientation[m_order[index]] = static_cast<int16_t>(orientation);
+}
+
+void ImageCatalog::setFormat(size_t index, ImageFormat format) {
+    m_format[m_order[index]] = static_cast<uint8_t>(format);
+}
+
+void ImageCatalog::setCaptureTime(size_t index, int64_t captureTime) {
+    m_captureTime[m_order[index]] = captureTime;
+}
+
+void ImageCatalog::sort(SortMode mode) {
+    m_sortMode = mode;
+    const size_t count = m_order.size();
+    if (count < 2) return;
+
+    // 路径和自然顺序的名次每组条目只计算一次，切换排序方式时直接使用
+    bool natural = mode == SortMode::Natural;
+    TextRank& textRank = natural ? m_naturalRank : m_pathRank;
+    if (!textRank.valid) {
+        computeTextRank(natural, textRank);
+    }
+    std::vector<uint32_t> byRank(textRank.limit, NO_POSITION);
+    for (uint32_t slot : m_order) {
+        byRank[textRank.rank[slot]] = slot;
+    }
+    byRank.erase(std::remove(byRank.begin(), byRank.end(), NO_POSITION), byRank.end());
+    if (mode == SortMode::Path || natural) {
+        m_order = std::move(byRank);
+        rebuildPositions();
+        return;
+    }
+
+    // 按路径顺序排列后按元数据键稳定排序，键相同的条目保持路径顺序。
+    // 元数据未知的条目按路径顺序接在最后，不参与排序；其余的键减去最小值，高位相同的字节不必排序
+    constexpr uint64_t UNKNOWN = UINT64_MAX;
+    std::vector<KeyedSlot> items;
+    std::vector<uint32_t> unknown;
+    items.reserve(count);
+    uint64_t minimum = UNKNOWN;
+    for (uint32_t slot : byRank) {
+        uint64_t key = metadataKey(slot, mode);
+        if (key == UNKNOWN) {
+            unknown.push_back(slot);
+        } else {
+            items.push_back({key, slot});
+            minimum = std::min(minimum, key);
+        }
+    }
+    for (auto& item : items) {
+        item.key -= minimum;
+    }
+    const size_t known = items.size();
+    unsigned parts = 1;
+    if (known >= PARALLEL_SORT_MIN) {
+        parts = std::max(1u, std::min(std::thread::hardware_concurrency(), MAX_SORT_THREADS));
+    }
+    // 分段排序，再两两归并（归并也是稳定的）
+    std::vector<size_t> bounds(parts + 1);
+    for (unsigned part = 0; part <= parts; ++part) {
+        bounds[part] = known * part / parts;
+    }
+    parallelFor(parts, parts, [&](size_t begin, size_t end, unsigned) {
+        std::vector<KeyedSlot> buffer;
+        for (size_t part = begin; part < end; ++part) {
+            radixSort(items.data() + bounds[part], bounds[part + 1] - bounds[part], buffer);
+        }
+    });
+    auto keyLess = [](const KeyedSlot& a, const KeyedSlot& b) { return a.key < b.key; };
+    while (bounds.size() > 2) {
+        size_t merges = (bounds.size() - 1) / 2;
+        parallelFor(merges, static_cast<unsigned>(merges), [&](size_t begin, size_t end, unsigned) {
+            for (size_t merge = begin; merge < end; ++merge) {
+                std::inplace_merge(items.begin() + bounds[merge * 2], items.begin() + bounds[merge * 2 + 1],
+                                   items.begin() + bounds[merge * 2 + 2], keyLess);
+            }
+        });
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        if (merged.back() != known) merged.push_back(known);
+        bounds = std::move(merged);
+    }
+
+    for (size_t i = 0; i < known; ++i) {
+        m_order[i] = items[i].slot;
+    }
+    std::copy(unknown.begin(), unknown.end(), m_order.begin() + known);
+    rebuildPositions();
+}
+
+void ImageCatalog::computeTextRank(bool natural, TextRank& result) const {
+    const size_t count = m_order.size();
+
+    // 所有路径共有的前缀（通常是打开的目录）不参与比较
+    std::string_view first = slotPath(m_order[0]);
+    size_t skip = first.size();
+    for (size_t i = 1; i < count && skip > 0; ++i) {
+        std::string_view path = slotPath(m_order[i]);
+        skip = static_cast<size_t>(std::mismatch(first.begin(), first.begin() + std::min(skip, path.size()),
+                                                 path.begin()).first - first.begin());
+    }
+    // 不能从数字串中间截断，否则数值比较出错
+    while (natural && skip > 0 && isDigit(first[skip - 1])) --skip;
+
+    // 比较用的文本：路径本身，或自然顺序的编码（每段线程写入自己的内存块）
+    std::vector<std::string_view> texts(m_pathOffset.size());
+    unsigned parts = 1;
+    if (count >= PARALLEL_SORT_MIN) {
+        parts = std::max(1u, std::min(std::thread::hardware_concurrency(), MAX_SORT_THREADS));
+    }
+    std::vector<std::string> arenas(parts);
+    parallelFor(count, parts, [&](size_t begin, size_t end, unsigned part) {
+        if (!natural) {
+            for (size_t i = begin; i < end; ++i) {
+                texts[m_order[i]] = slotPath(m_order[i]).substr(skip);
+            }
+            return;
+        }
+        std::string& arena = arenas[part];
+        size_t bytes = 0;
+        for (size_t i = begin; i < end; ++i) {
+            bytes += m_pathLength[m_order[i]] - skip;
+        }
+        // 编码通常比路径略长，预留后多数情况下不再扩容
+        arena.reserve(bytes + bytes / 2);
+        std::vector<size_t> offsets;
+        offsets.reserve(end - begin + 1);
+        for (size_t i = begin; i < end; ++i) {
+            offsets.push_back(arena.size());
+            appendNaturalKey(arena, slotPath(m_order[i]).substr(skip));
+        }
+        offsets.push_back(arena.size());
+        // arena 不再增长后才能取视图
+        for (size_t i = begin; i < end; ++i) {
+            size_t offset = offsets[i - begin];
+            texts[m_order[i]] = std::string_view(arena.data() + offset, offsets[i - begin + 1] - offset);
+        }
+    });
+
+    std::vector<KeyedSlot> items(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t slot = m_order[i];
+        items[i] = {packPrefix(texts[slot], !natural), slot};
+    }
+    std::vector<KeyedSlot> buffer;
+    radixSort(items.data(), count, buffer);
+    // 前 8 字节相同的各组互不相干，分给多个线程继续比较
+    std::vector<size_t> runs{0};
+    for (size_t i = 1; i < count; ++i) {
+        if (items[i].key != items[i - 1].key) runs.push_back(i);
+    }
+    runs.push_back(count);
+    const size_t runCount = runs.size() - 1;
+    parallelFor(runCount, static_cast<unsigned>(std::min<size_t>(parts, runCount)),
+                [&](size_t begin, size_t end, unsigned part) {
+        std::vector<KeyedSlot> localBuffer;
+        std::vector<KeyedSlot>& runBuffer = part == 0 ? buffer : localBuffer;
+        for (size_t run = begin; run < end; ++run) {
+            refineRun(items.data() + runs[run], runs[run + 1] - runs[run], 8, texts, natural, runBuffer);
+        }
+    });
+
+    result.rank.assign(m_pathOffset.size(), 0);
+    for (size_t i = 0; i < count; ++i) {
+        result.rank[items[i].slot] = static_cast<uint32_t>(i);
+    }
+    result.limit = static_cast<uint32_t>(count);
+    result.valid = true;
+}
+
+void ImageCatalog::sortTexts(KeyedSlot* items, size_t count, size_t depth,
+                             const std::vector<std::string_view>& texts, bool natural,
+                             std::vector<KeyedSlot>& buffer) const {
+    // 按 8 字节分段比较：先按当前一段排序，这一段相同的再比较下一段
+    radixSort(items, count, buffer);
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin + 1;
+        while (end < count && items[end].key == items[begin].key) ++end;
+        refineRun(items + begin, end - begin, depth + 8, texts, natural, buffer);
+        begin = end;
+    }
+}
+
+void ImageCatalog::refineRun(KeyedSlot* run, size_t length, size_t depth,
+                             const std::vector<std::string_view>& texts, bool natural,
+                             std::vector<KeyedSlot>& buffer) const {
+    if (length < 2) return;
+    bool longer = std::any_of(run, run + length, [&](const KeyedSlot& item) { return texts[item.slot].size() > depth; });
+    if (!longer) {
+        // 文本完全相同：自然顺序中只差大小写或前导零，按路径排序
+        if (natural) {
+            std::sort(run, run + length, [this](const KeyedSlot& a, const KeyedSlot& b) {
+                return pathLess(slotPath(a.slot), slotPath(b.slot));
+            });
+        }
+        return;
+    }
+    if (length <= SMALL_TEXT_RUN) {
+        std::sort(run, run + length, [&](const KeyedSlot& a, const KeyedSlot& b) {
+            std::string_view ta = tail(texts[a.slot], depth), tb = tail(texts[b.slot], depth);
+            if (!natural) return pathLess(ta, tb);
+            if (ta != tb) return ta < tb;
+            return pathLess(slotPath(a.slot), slotPath(b.slot));
+        });
+        return;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        run[i].key = packPrefix(tail(texts[run[i].slot], depth), !natural);
+    }
+    sortTexts(run, length, depth, texts, natural, buffer);
+}
+
+void ImageCatalog::radixSort(KeyedSlot* items, size_t count, std::vector<KeyedSlot>& buffer) {
+    if (count < 64) {
+        std::stable_sort(items, items + count, [](const KeyedSlot& a, const KeyedSlot& b) { return a.key < b.key; });
+        return;
+    }
+    std::vector<std::array<size_t, 256>> histogram(8);
+    for (auto& counts : histogram) counts.fill(0);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t key = items[i].key;
+        for (int byte = 0; byte < 8; ++byte) {
+            ++histogram[byte][(key >> (byte * 8)) & 0xFF];
+        }
+    }
+    buffer.resize(std::max(buffer.size(), count));
+    KeyedSlot* source = items;
+    KeyedSlot* target = buffer.data();
+    for (int byte = 0; byte < 8; ++byte) {
+        auto& counts = histogram[byte];
+        if (std::find(counts.begin(), counts.end(), count) != counts.end()) continue;
+        size_t offset = 0;
+        for (auto& bucket : counts) {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            target[counts[(source[i].key >> (byte * 8)) & 0xFF]++] = source[i];
+        }
+        std::swap(source, target);
+    }
+    if (source != items) {
+        std::copy(source, source + count, items);
+    }
+}
+
+uint64_t ImageCatalog::metadataKey(uint32_t slot, SortMode mode) const {
+    constexpr uint64_t UNKNOWN = UINT64_MAX;
+    // 有符号时间翻转符号位后按无符号比较，顺序不变
+    auto timeKey = [](int64_t time) {
+        return time == 0 ? UNKNOWN : static_cast<uint64_t>(time) ^ (uint64_t(1) << 63);
+    };
+    switch (mode) {
+        case SortMode::Modified:
+            return timeKey(m_modified[slot]);
+        case SortMode::CaptureTime:
+            return timeKey(m_captureTime[slot]);
+        case SortMode::FileSize:
+            return m_fileSize[slot];
+        case SortMode::Dimensions:
+            return m_width[slot] == 0 ? UNKNOWN : uint64_t(m_width[slot]) * m_height[slot];
+        default:
+            return 0;
+    }
+}
+
+ImageCatalog::SortItem ImageCatalog::makeSortItem(uint32_t slot, SortMode mode, size_t skip, std::string& arena) const {
+    SortItem item;
+    item.key = metadataKey(slot, mode);
+    item.slot = slot;
+    std::string_view path = slotPath(slot).substr(skip);
+    if (mode == SortMode::Natural) {
+        size_t offset = arena.size();
+        appendNaturalKey(arena, path);
+        item.text = std::string_view(arena.data() + offset, arena.size() - offset);
+        item.prefix = packPrefix(item.text, false);
+    } else {
+        item.text = path;
+        item.prefix = packPrefix(path, true);
+    }
+    return item;
+}
+
+bool ImageCatalog::itemLess(const SortItem& a, const SortItem& b) const {
+    if (a.key != b.key) return a.key < b.key;
+    if (a.prefix != b.prefix) return a.prefix < b.prefix;
+    if (m_sortMode != SortMode::Natural) {
+        return pathLess(a.text, b.text);
+    }
+    if (a.text != b.text) return a.text < b.text;
+    // 编码相同（只差大小写或前导零）时按路径
+    return pathLess(slotPath(a.slot), slotPath(b.slot));
+}
+
+bool ImageCatalog::pathLess(std::string_view a, std::string_view b) {
+    // 分隔符视为最小的字符，同一目录的文件排在其他同名前缀的目录之前
+    size_t length = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (true) {
+        // 相同的前缀（通常是目录）按字节快速跳过
+        i = static_cast<size_t>(std::mismatch(a.begin() + i, a.begin() + length, b.begin() + i).first - a.begin());
+        if (i == length) return a.size() < b.size();
+        bool sa = isSeparator(a[i]), sb = isSeparator(b[i]);
+        if (sa && sb) {
+            ++i; // 两种分隔符视为相同
+            continue;
+        }
+        unsigned char ca = sa ? 1 : static_cast<unsigned char>(a[i]);
+        unsigned char cb = sb ? 1 : static_cast<unsigned char>(b[i]);
+        return ca < cb;
+    }
+}
+
+size_t ImageCatalog::memoryUsage() const {
+    size_t perSlot = sizeof(uint32_t) * 5 + sizeof(uint64_t) + sizeof(int64_t) * 2 + sizeof(int16_t) + sizeof(uint8_t);
+    return m_arena.size() + m_pathOffset.size() * perSlot +
+           (m_order.size() + m_table.size() + m_freeSlots.size() +
+            m_pathRank.rank.size() + m_naturalRank.rank.size()) * sizeof(uint32_t);
+}
+
+uint32_t ImageCatalog::allocateSlot(std::string_view utf8Path, uint32_t hash) {
+    // 新条目没有名次，下次排序时重新计算
+    m_pathRank.valid = false;
+    m_naturalRank.valid = false;
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_pathOffset.size());
+        m_pathOffset.push_back(0);
+        m_pathLength.push_back(0);
+        m_hash.push_back(0);
+        m_fileSize.push_back(0);
+        m_modified.push_back(0);
+        m_captureTime.push_back(0);
+        m_width.push_back(0);
+        m_height.push_back(0);
+        m_orientation.push_back(UNKNOWN_ORIENTATION);
+        m_format.push_back(0);
+        m_position.push_back(NO_POSITION);
+    }
+
+    m_pathOffset[slot] = static_cast<uint32_t>(m_arena.size());
+    m_pathLength[slot] = static_cast<uint32_t>(utf8Path.size());
+    m_arena.append(utf8Path);
+    m_hash[slot] = hash;
+    m_fileSize[slot] = 0;
+    m_modified[slot] = 0;
+    m_captureTime[slot] = 0;
+    m_width[slot] = 0;
+    m_height[slot] = 0;
+    m_orientation[slot] = UNKNOWN_ORIENTATION;
+    m_format[slot] = static_cast<uint8_t>(formatFromPath(utf8Path));
+    return slot;
+}
+
+void ImageCatalog::releaseSlot(uint32_t slot) {
+    eraseHash(slot);
+    m_garbageBytes += m_pathLength[slot];
+    m_pathLength[slot] = 0;
+    m_position[slot] = NO_POSITION;
+    m_freeSlots.push_back(slot);
+}
+
+void ImageCatalog::compactIfNeeded() {
+    if (m_garbageBytes > COMPACT_MIN_GARBAGE && m_garbageBytes * 2 > m_arena.size()) {
+        compactArena();
+    }
+}
+
+void ImageCatalog::rebuildPositions(size_t from) {
+    for (size_t i = from; i < m_order.size(); ++i) {
+        m_position[m_order[i]] = static_cast<uint32_t>(i);
+    }
+}
+
+std::string_view ImageCatalog::slotPath(uint32_t slot) const {
+    return std::string_view(m_arena.data() + m_pathOffset[slot], m_pathLength[slot]);
+}
+
+uint32_t ImageCatalog::hashPath(std::string_view utf8Path) {
+    // FNV-1a 32 位哈希
+    uint32_t hash = 2166136261u;
+    for (char c : utf8Path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+size_t ImageCatalog::findSlot(std::string_view utf8Path, uint32_t hash) const {
+    if (m_table.empty()) return npos;
+    size_t mask = m_table.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        uint32_t entry = m_table[i];
+        if (entry == 0) return npos;
+        uint32_t slot = entry - 1;
+        if (m_hash[slot] == hash && slotPath(slot) == utf8Path) return slot;
+    }
+}
+
+void ImageCatalog::insertHash(uint32_t slot) {
+    // 在加入显示顺序之前调用。装载率不超过 1/2，探测序列保持很短
+    if ((size() + 1) * 2 > m_table.size()) {
+        growTable();
+    }
+    size_t mask = m_table.size() - 1;
+    size_t i = m_hash[slot] & mask;
+    while (m_table[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    m_table[i] = slot + 1;
+}
+
+void ImageCatalog::eraseHash(uint32_t slot) {
+    size_t mask = m_table.size() - 1;
+    size_t i = m_hash[slot] & mask;
+    while (m_table[i] != slot + 1) {
+        i = (i + 1) & mask;
+    }
+    // 向后移动删除：后续条目若不在其理想位置与空位之间，就前移填补空位，不留墓碑
+    for (size_t j = i;;) {
+        j = (j + 1) & mask;
+        if (m_table[j] == 0) break;
+        size_t ideal = m_hash[m_table[j] - 1] & mask;
+        bool between = (i <= j) ? (i < ideal && ideal <= j) : (i < ideal || ideal <= j);
+        if (!between) {
+            m_table[i] = m_table[j];
+            i = j;
+        }
+    }
+    m_table[i] = 0;
+}
+
+void ImageCatalog::growTable() {
+    size_t capacity = std::max<size_t>(16, m_table.size() * 2);
+    while (capacity < (size() + 1) * 2) capacity *= 2;
+    m_table.assign(capacity, 0);
+    size_t mask = capacity - 1;
+    for (uint32_t slot : m_order) {
+        size_t i = m_hash[slot] & mask;
+        while (m_table[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        m_table[i] = slot + 1;
+    }
+}
+
+void ImageCatalog::compactArena() {
+    std::string arena;
+    arena.reserve(m_arena.size() - m_garbageBytes);
+    for (uint32_t slot = 0; slot < m_pathOffset.size(); ++slot) {
+        if (m_position[slot] == NO_POSITION) continue;
+        std::string_view path = slotPath(slot);
+        m_pathOffset[slot] = static_cast<uint32_t>(arena.size());
+        arena.append(path);
+    }
+    m_arena = std::move(arena);
+    m_garbageBytes = 0;
+}
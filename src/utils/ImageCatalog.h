@@ -0,0 +1,175 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include "ImageDecoder.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * @class ImageCatalog
+ * @brief 图片列表：路径、文件名和每张图片的元数据
+ * @description 所有路径（UTF-8）依次存放在一块连续内存中，文件名是路径末尾的一段，不单独保存。
+ *              大小、修改时间、尺寸、方向、格式按字段分别存放在数组中（结构数组转为数组结构），
+ *              排序和筛选只读取需要的字段。路径到条目的哈希索引使查找为 O(1)。
+ *              条目存放在固定的槽位中，显示顺序是槽位号的数组，排序只重排这个数组。
+ *              不是线程安全的，扫描线程各自填充小的目录再由主线程合并
+ */
+class ImageCatalog {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr int UNKNOWN_ORIENTATION = -100; // 与 EXIF 解析结果一致
+
+    enum class SortMode {
+        Path,           // 按路径逐字节比较
+        Natural,        // 自然顺序：数字按数值比较，不区分大小写（img2 在 img10 之前）
+        Modified,       // 修改时间
+        CaptureTime,    // EXIF 拍摄时间
+        FileSize,
+        Dimensions      // 像素数
+    };
+    static constexpr int SORT_MODE_COUNT = 6;
+    // 配置文件中的名称
+    static const char* sortModeName(SortMode mode);
+    static SortMode sortModeFromName(const std::string& name);
+
+    ImageCatalog() = default;
+    ImageCatalog(ImageCatalog&&) = default;
+    ImageCatalog& operator=(ImageCatalog&&) = default;
+    ImageCatalog(const ImageCatalog&) = delete;
+    ImageCatalog& operator=(const ImageCatalog&) = delete;
+
+    size_t size() const { return m_order.size(); }
+    bool empty() const { return m_order.empty(); }
+    void clear();
+    void reserve(size_t count);
+
+    // 追加到末尾，路径已存在时返回原位置
+    size_t add(const fs::path& path) { return addUtf8(path.u8string()); }
+    size_t addUtf8(std::string_view utf8Path);
+    // 按当前排序方式插入到对应位置（列表须已排序），已存在时返回原位置
+    size_t insertSorted(const fs::path& path, uint64_t size = 0, int64_t modified = 0);
+    // 合并另一个目录的条目（连同元数据），已存在的跳过
+    void append(const ImageCatalog& other);
+    bool erase(const fs::path& path);
+    // 删除目录（含子目录）下的所有条目，返回删除的数量
+    size_t eraseDirectory(const fs::path& directory);
+
+    // 不存在时返回 npos
+    size_t find(const fs::path& path) const { return findUtf8(path.u8string()); }
+    size_t findUtf8(std::string_view utf8Path) const;
+    // 按路径排序时 path 所在或应插入的位置（列表须已排序）
+    size_t lowerBound(const fs::path& path) const { return lowerBoundUtf8(path.u8string()); }
+    size_t lowerBoundUtf8(std::string_view utf8Path) const;
+
+    fs::path path(size_t index) const { return fs::u8path(pathView(index)); }
+    std::string_view pathView(size_t index) const;
+    std::string_view nameView(size_t index) const;
+    std::string name(size_t index) const { return std::string(nameView(index)); }
+
+    uint64_t fileSize(size_t index) const { return m_fileSize[m_order[index]]; }
+    int64_t modifiedTime(size_t index) const { return m_modified[m_order[index]]; }
+    int64_t captureTime(size_t index) const { return m_captureTime[m_order[index]]; }
+    int width(size_t index) const { return static_cast<int>(m_width[m_order[index]]); }
+    int height(size_t index) const { return static_cast<int>(m_height[m_order[index]]); }
+    int orientation(size_t index) const { return m_orientation[m_order[index]]; }
+    ImageFormat format(size_t index) const { return static_cast<ImageFormat>(m_format[m_order[index]]); }
+    // 已读取文件头（方向已知）
+    bool hasHeaderInfo(size_t index) const { return orientation(index) != UNKNOWN_ORIENTATION; }
+
+    void setFileInfo(size_t index, uint64_t size, int64_t modified);
+    void setDimensions(size_t index, int width, int height);
+    void setOrientation(size_t index, int orientation);
+    void setFormat(size_t index, ImageFormat format);
+    // 秒（UTC 纪元起），0 表示未知
+    void setCaptureTime(size_t index, int64_t captureTime);
+
+    /**
+     * @brief 重排显示顺序，只使用已记录的元数据，不访问文件
+     * @description 路径和自然顺序的名次在加入新条目后首次排序时计算一次，之后切换排序方式只按名次重排；
+     *              按元数据排序时以路径名次为初始顺序，对 64 位键做稳定的基数排序，条目多时分段多线程排序后归并。
+     *              元数据未知的条目排在最后，元数据相同时按路径排序
+     */
+    void sort(SortMode mode);
+    void sortByPath() { sort(SortMode::Path); }
+    SortMode sortMode() const { return m_sortMode; }
+    // 同一目录的文件排在一起，与逐级比较路径的结果一致
+    static bool pathLess(std::string_view a, std::string_view b);
+
+    // 条目和索引占用的内存（不含未使用的容量）
+    size_t memoryUsage() const;
+
+private:
+    struct SortItem {
+        uint64_t key;           // 元数据键，未知时为最大值
+        uint64_t prefix;        // 文本键的前 8 个字节（大端），多数比较到这里就能分出先后
+        std::string_view text;  // 完整的文本键：路径，或自然顺序编码后的路径
+        uint32_t slot;
+    };
+    // 按路径或自然顺序的名次，已删除条目留下的空缺不影响先后
+    struct TextRank {
+        std::vector<uint32_t> rank;     // 槽位 -> 名次
+        uint32_t limit = 0;             // 名次上限
+        bool valid = false;             // 加入新条目后失效
+    };
+    struct KeyedSlot {
+        uint64_t key;
+        uint32_t slot;
+    };
+    // 按 key 稳定排序（LSD 基数排序），所有条目都相同的字节跳过
+    static void radixSort(KeyedSlot* items, size_t count, std::vector<KeyedSlot>& buffer);
+    void computeTextRank(bool natural, TextRank& result) const;
+    void sortTexts(KeyedSlot* items, size_t count, size_t depth,
+                   const std::vector<std::string_view>& texts, bool natural,
+                   std::vector<KeyedSlot>& buffer) const;
+    // 前 depth 个字节相同的一组继续比较
+    void refineRun(KeyedSlot* run, size_t length, size_t depth,
+                   const std::vector<std::string_view>& texts, bool natural,
+                   std::vector<KeyedSlot>& buffer) const;
+    uint64_t metadataKey(uint32_t slot, SortMode mode) const;
+    // skip：所有路径共有、比较时可以跳过的前缀长度；natural 模式的编码写入 arena
+    SortItem makeSortItem(uint32_t slot, SortMode mode, size_t skip, std::string& arena) const;
+    bool itemLess(const SortItem& a, const SortItem& b) const;
+
+    uint32_t allocateSlot(std::string_view utf8Path, uint32_t hash);
+    // 只记录空闲槽位，之后由调用者调用 compactIfNeeded()
+    void releaseSlot(uint32_t slot);
+    // 已删除的路径超过一半时整理 m_arena
+    void compactIfNeeded();
+    // 顺序数组变化后重建槽位到位置的映射
+    void rebuildPositions(size_t from = 0);
+    std::string_view slotPath(uint32_t slot) const;
+
+    static uint32_t hashPath(std::string_view utf8Path);
+    size_t findSlot(std::string_view utf8Path, uint32_t hash) const;
+    void insertHash(uint32_t slot);
+    void eraseHash(uint32_t slot);
+    void growTable();
+    void compactArena();
+
+    std::string m_arena;                // 所有路径首尾相接
+    size_t m_garbageBytes = 0;          // 已删除条目留在 m_arena 中的字节
+
+    // 每个槽位一项
+    std::vector<uint32_t> m_pathOffset;
+    std::vector<uint32_t> m_pathLength;
+    std::vector<uint32_t> m_hash;
+    std::vector<uint64_t> m_fileSize;
+    std::vector<int64_t> m_modified;
+    std::vector<int64_t> m_captureTime;
+    std::vector<uint32_t> m_width;      // 0 表示未知
+    std::vector<uint32_t> m_height;
+    std::vector<int16_t> m_orientation;
+    std::vector<uint8_t> m_format;
+    std::vector<uint32_t> m_position;   // 槽位在显示顺序中的位置，空闲槽位为 UINT32_MAX
+    std::vector<uint32_t> m_freeSlots;
+
+    std::vector<uint32_t> m_order;      // 显示顺序：位置 -> 槽位
+    SortMode m_sortMode = SortMode::Path;
+    TextRank m_pathRank;
+    TextRank m_naturalRank;
+    std::vector<uint32_t> m_table;      // 开放寻址哈希表，存放槽位号 + 1，0 表示空
+};
@@ -0,0 +1,143 @@
+#include "ImageDecoder.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+ImageFormat DetectImageFormat(const unsigned char* data, size_t size) {
+    auto startsWith = [&](const char* magic, size_t length, size_t offset = 0) {
+        return size >= offset + length && std::memcmp(data + offset, magic, length) == 0;
+    };
+    if (!data) return ImageFormat::Unknown;
+
+    if (startsWith("\xFF\xD8\xFF", 3)) return ImageFormat::JPEG;
+    if (startsWith("\x89PNG\r\n\x1A\n", 8)) return ImageFormat::PNG;
+    if (startsWith("GIF87a", 6) || startsWith("GIF89a", 6)) return ImageFormat::GIF;
+    if (startsWith("BM", 2)) return ImageFormat::BMP;
+    if (startsWith("II*\0", 4) || startsWith("MM\0*", 4)) return ImageFormat::TIFF;
+    if (startsWith("#?RADIANCE", 10) || startsWith("#?RGBE", 6)) return ImageFormat::HDR;
+    if (startsWith("8BPS", 4)) return ImageFormat::PSD;
+    if (startsWith("RIFF", 4) && startsWith("WEBP", 4, 8)) return ImageFormat::WEBP;
+    if (size >= 2 && data[0] == 'P' && (data[1] == '5' || data[1] == '6')) return ImageFormat::PNM;
+    // TGA 没有魔数，交给 stb_image 尝试
+    return ImageFormat::Unknown;
+}
+
+bool IsAnimatedPng(const unsigned char* data, size_t size) {
+    if (DetectImageFormat(data, size) != ImageFormat::PNG) return false;
+    size_t pos = 8;
+    while (pos + 8 <= size) {
+        size_t length = (static_cast<size_t>(data[pos]) << 24) | (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
+        const unsigned char* type = data + pos + 4;
+        if (std::memcmp(type, "acTL", 4) == 0) return true;
+        if (std::memcmp(type, "IDAT", 4) == 0 || std::memcmp(type, "IEND", 4) == 0) return false;
+        pos += 12 + length;
+    }
+    return false;
+}
+
+const char* ImageFormatName(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::JPEG: return "JPEG";
+        case ImageFormat::PNG: return "PNG";
+        case ImageFormat::GIF: return "GIF";
+        case ImageFormat::BMP: return "BMP";
+        case ImageFormat::TIFF: return "TIFF";
+        case ImageFormat::HDR: return "HDR";
+        case ImageFormat::PSD: return "PSD";
+        case ImageFormat::PNM: return "PNM";
+        case ImageFormat::WEBP: return "WEBP";
+        default: return "Unknown";
+    }
+}
+
+////////////////////////////////   stb_image   ///////////////////////////////
+namespace {
+class StbDecoder : public ImageDecoder {
+public:
+    const char* name() const override { return "stb_image"; }
+    // GIF 的多帧由 AnimatedImage 合成
+    bool canDecode(ImageFormat format) const override { return format != ImageFormat::GIF; }
+
+    unsigned char* decode(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                          int desiredChannels, const std::atomic<bool>* cancel) override {
+        if (size > static_cast<size_t>(INT_MAX)) return nullptr;
+        // stb_image 解码过程中无法中断，只在开始前和结束后检查取消标记，直接从内存（映射）解码
+        if (cancel && cancel->load(std::memory_order_relaxed)) return nullptr;
+        unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, desiredChannels);
+        if (pixels && cancel && cancel->load(std::memory_order_relaxed)) {
+            stbi_image_free(pixels);
+            return nullptr;
+        }
+        if (!pixels) {
+            std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+        }
+        return pixels;
+    }
+};
+}
+
+std::unique_ptr<ImageDecoder> CreateStbDecoder() {
+    return std::make_unique<StbDecoder>();
+}
+
+////////////////////////////////   registry   ///////////////////////////////
+ImageDecoderRegistry& ImageDecoderRegistry::getInstance() {
+    static ImageDecoderRegistry instance;
+    return instance;
+}
+
+ImageDecoderRegistry::ImageDecoderRegistry() {
+#ifdef VIMAG_WITH_LIBJPEG_TURBO
+    m_decoders.push_back(CreateLibJpegDecoder());
+#endif
+    m_decoders.push_back(CreateStbDecoder());
+}
+
+void ImageDecoderRegistry::registerDecoder(std::unique_ptr<ImageDecoder> decoder) {
+    if (!decoder) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoders.insert(m_decoders.end() - 1, std::move(decoder));
+}
+
+std::vector<ImageDecoder*> ImageDecoderRegistry::getDecoders(ImageFormat format) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<ImageDecoder*> decoders;
+    for (const auto& decoder : m_decoders) {
+        if (decoder->canDecode(format)) {
+            decoders.push_back(decoder.get());
+        }
+    }
+    return decoders;
+}
+
+unsigned char* ImageDecoderRegistry::decode(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                                            int desiredChannels, const std::atomic<bool>* cancel) {
+    ImageFormat format = DetectImageFormat(data, size);
+    // 解码器只增不减，取出指针后在锁外解码
+    for (ImageDecoder* decoder : getDecoders(format)) {
+        unsigned char* pixels = decoder->decode(data, size, width, height, channels, desiredChannels, cancel);
+        if (pixels) return pixels;
+        if (cancel && cancel->load(std::memory_order_relaxed)) return nullptr;
+    }
+    return nullptr;
+}
+
+unsigned char* ImageDecoderRegistry::decodeReduced(const unsigned char* data, size_t size, int minSize, int& width, int& height,
+                                                   int& sourceWidth, int& sourceHeight, const std::atomic<bool>* cancel) {
+    ImageFormat format = DetectImageFormat(data, size);
+    for (ImageDecoder* decoder : getDecoders(format)) {
+        unsigned char* pixels = decoder->decodeReduced(data, size, minSize, width, height, sourceWidth, sourceHeight, cancel);
+        if (pixels) return pixels;
+    }
+    return nullptr;
+}
+
+std::unique_ptr<RowReader> ImageDecoderRegistry::openRows(const unsigned char* data, size_t size) {
+    ImageFormat format = DetectImageFormat(data, size);
+    for (ImageDecoder* decoder : getDecoders(format)) {
+        if (auto reader = decoder->openRows(data, size)) return reader;
+    }
+    return nullptr;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// 按文件头魔数识别的图像格式，与扩展名无关
+enum class ImageFormat {
+    Unknown, JPEG, PNG, GIF, BMP, TIFF, HDR, PSD, PNM, WEBP
+};
+
+ImageFormat DetectImageFormat(const unsigned char* data, size_t size);
+const char* ImageFormatName(ImageFormat format);
+// PNG 在 IDAT 之前带有 acTL 块（APNG），由 AnimatedImage 播放
+bool IsAnimatedPng(const unsigned char* data, size_t size);
+
+/**
+ * @class RowReader
+ * @brief 按扫描行顺序解码，整幅像素不必同时在内存中
+ * @description 解码期间输入数据须保持有效
+ */
+class RowReader {
+public:
+    virtual ~RowReader() = default;
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+    // 读取接下来的 count 行 RGBA，行距 width * 4；出错时返回 false
+    virtual bool readRows(unsigned char* rows, int count) = 0;
+};
+
+/**
+ * @class ImageDecoder
+ * @brief 解码器接口
+ * @description 输出与 stb_image 一致：像素使用 STBI_MALLOC 分配（FreeImage 释放），
+ *              channels 返回文件本身的通道数。不支持的输入返回 nullptr，由注册表交给下一个解码器
+ */
+class ImageDecoder {
+public:
+    virtual ~ImageDecoder() = default;
+    virtual const char* name() const = 0;
+    virtual bool canDecode(ImageFormat format) const = 0;
+    // cancel 置位后返回 nullptr；能逐行解码的实现（libjpeg-turbo）在解码途中检查，其余在开始前和结束后检查
+    virtual unsigned char* decode(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                                  int desiredChannels, const std::atomic<bool>* cancel) = 0;
+    // 解码时直接缩小（JPEG 的 DCT 缩放，最多 1/8），长边不小于 minSize，输出 RGBA。
+    // 缩小不足 1/4 或不支持时返回 nullptr
+    virtual unsigned char* decodeReduced(const unsigned char* /*data*/, size_t /*size*/, int /*minSize*/,
+                                         int& /*width*/, int& /*height*/, int& /*sourceWidth*/, int& /*sourceHeight*/,
+                                         const std::atomic<bool>* /*cancel*/) {
+        return nullptr;
+    }
+    // 按行解码，不支持时返回 nullptr
+    virtual std::unique_ptr<RowReader> openRows(const unsigned char* /*data*/, size_t /*size*/) {
+        return nullptr;
+    }
+};
+
+// stb_image，支持全部格式，作为兜底
+std::unique_ptr<ImageDecoder> CreateStbDecoder();
+#ifdef VIMAG_WITH_LIBJPEG_TURBO
+// libjpeg-turbo（SIMD），只处理 JPEG
+std::unique_ptr<ImageDecoder> CreateLibJpegDecoder();
+#endif
+
+/**
+ * @class ImageDecoderRegistry
+ * @brief 按魔数选择解码器
+ * @description 先注册的解码器优先，失败时依次尝试后面的解码器，stb_image 始终排在最后
+ */
+class ImageDecoderRegistry {
+public:
+    static ImageDecoderRegistry& getInstance();
+
+    // 插入到 stb_image 之前
+    void registerDecoder(std::unique_ptr<ImageDecoder> decoder);
+    // 按优先级列出能解码该格式的解码器（解码测试用）
+    std::vector<ImageDecoder*> getDecoders(ImageFormat format);
+
+    unsigned char* decode(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                          int desiredChannels = 4, const std::atomic<bool>* cancel = nullptr);
+    // 快速得到缩小的图像，用于完整解码完成前的占位图
+    unsigned char* decodeReduced(const unsigned char* data, size_t size, int minSize, int& width, int& height,
+                                 int& sourceWidth, int& sourceHeight, const std::atomic<bool>* cancel = nullptr);
+    // 按行解码，用于超大图像分块；没有支持该格式的解码器时返回 nullptr
+    std::unique_ptr<RowReader> openRows(const unsigned char* data, size_t size);
+
+private:
+    ImageDecoderRegistry();
+    ImageDecoderRegistry(const ImageDecoderRegistry&) = delete;
+    ImageDecoderRegistry& operator=(const ImageDecoderRegistry&) = delete;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ImageDecoder>> m_decoders;
+};
@@ -0,0 +1,202 @@
+#include "ImageDecoder.h"
+
+#ifdef VIMAG_WITH_LIBJPEG_TURBO
+#include "utils.h"
+#include <cstdio>
+#include <csetjmp>
+#include <algorithm>
+#include <iostream>
+#include <jpeglib.h>
+
+namespace {
+// libjpeg 出错时调用 error_exit，默认实现会退出进程，这里跳回 decode
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info) {
+    auto* error = reinterpret_cast<JpegErrorManager*>(info->err);
+    char message[JMSG_LENGTH_MAX];
+    (*info->err->format_message)(info, message);
+    std::cerr << "libjpeg Error: " << message << std::endl;
+    longjmp(error->jump, 1);
+}
+
+// 警告（如文件末尾被截断）不输出，能解出的部分照常显示
+void jpegOutputMessage(j_common_ptr) {}
+
+// 按行解码，超大图像分块时每次只解出一行图块
+class JpegRowReader : public RowReader {
+public:
+    static constexpr int ROWS_PER_READ = 16;
+
+    JpegRowReader() = default;
+    ~JpegRowReader() override {
+        if (m_created) jpeg_destroy_decompress(&m_info);
+    }
+    JpegRowReader(const JpegRowReader&) = delete;
+    JpegRowReader& operator=(const JpegRowReader&) = delete;
+
+    bool open(const unsigned char* data, size_t size) {
+        m_info.err = jpeg_std_error(&m_error.base);
+        m_error.base.error_exit = jpegErrorExit;
+        m_error.base.output_message = jpegOutputMessage;
+        if (setjmp(m_error.jump)) return false;
+
+        jpeg_create_decompress(&m_info);
+        m_created = true;
+        jpeg_mem_src(&m_info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+        jpeg_read_header(&m_info, TRUE);
+        if (m_info.jpeg_color_space == JCS_CMYK || m_info.jpeg_color_space == JCS_YCCK) return false;
+        // 渐进式 JPEG 要先缓存全部系数才能输出首行，按行读取省不了内存
+        if (jpeg_has_multiple_scans(&m_info)) return false;
+        m_info.out_color_space = JCS_EXT_RGBA;
+        jpeg_start_decompress(&m_info);
+        return true;
+    }
+
+    int getWidth() const override { return static_cast<int>(m_info.output_width); }
+    int getHeight() const override { return static_cast<int>(m_info.output_height); }
+
+    bool readRows(unsigned char* rows, int count) override {
+        if (count <= 0 || m_info.output_scanline + static_cast<JDIMENSION>(count) > m_info.output_height) return false;
+        if (setjmp(m_error.jump)) return false;
+        size_t stride = static_cast<size_t>(m_info.output_width) * 4;
+        JDIMENSION start = m_info.output_scanline;
+        JDIMENSION end = start + static_cast<JDIMENSION>(count);
+        JSAMPROW batch[ROWS_PER_READ];
+        while (m_info.output_scanline < end) {
+            int batchRows = std::min<int>(ROWS_PER_READ, static_cast<int>(end - m_info.output_scanline));
+            for (int i = 0; i < batchRows; ++i) {
+                batch[i] = rows + (m_info.output_scanline - start + i) * stride;
+            }
+            jpeg_read_scanlines(&m_info, batch, static_cast<JDIMENSION>(batchRows));
+        }
+        return true;
+    }
+
+private:
+    jpeg_decompress_struct m_info;
+    JpegErrorManager m_error;
+    bool m_created = false;
+};
+
+class LibJpegDecoder : public ImageDecoder {
+public:
+    static constexpr int ROWS_PER_READ = 16; // 每次读取的扫描行数，读完一批检查一次取消标记
+
+    const char* name() const override { return "libjpeg-turbo"; }
+    bool canDecode(ImageFormat format) const override { return format == ImageFormat::JPEG; }
+
+    unsigned char* decode(const unsigned char* data, size_t size, int& width, int& height, int& channels,
+                          int desiredChannels, const std::atomic<bool>* cancel) override {
+        // 其余通道数交给 stb_image
+        if (desiredChannels != 4) return nullptr;
+        int sourceWidth = 0, sourceHeight = 0;
+        return decodeJpeg(data, size, 0, width, height, channels, sourceWidth, sourceHeight, cancel);
+    }
+
+    unsigned char* decodeReduced(const unsigned char* data, size_t size, int minSize, int& width, int& height,
+                                 int& sourceWidth, int& sourceHeight, const std::atomic<bool>* cancel) override {
+        int channels = 0;
+        return decodeJpeg(data, size, std::max(1, minSize), width, height, channels, sourceWidth, sourceHeight, cancel);
+    }
+
+    std::unique_ptr<RowReader> openRows(const unsigned char* data, size_t size) override {
+        auto reader = std::make_unique<JpegRowReader>();
+        if (!reader->open(data, size)) return nullptr;
+        return reader;
+    }
+
+private:
+    // minSize 为 0 时按原尺寸解码，否则选择长边不小于 minSize 的最大缩放比例
+    unsigned char* decodeJpeg(const unsigned char* data, size_t size, int minSize, int& width, int& height, int& channels,
+                              int& sourceWidth, int& sourceHeight, const std::atomic<bool>* cancel) {
+        jpeg_decompress_struct info;
+        JpegErrorManager error;
+        info.err = jpeg_std_error(&error.base);
+        error.base.error_exit = jpegErrorExit;
+        error.base.output_message = jpegOutputMessage;
+        // setjmp 返回后局部变量只有 volatile 的才可靠
+        unsigned char* volatile pixels = nullptr;
+
+        if (setjmp(error.jump)) {
+            jpeg_destroy_decompress(&info);
+            unsigned char* failed = pixels;
+            FreeImage(failed, "");
+            return nullptr;
+        }
+
+        jpeg_create_decompress(&info);
+        jpeg_mem_src(&info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+        jpeg_read_header(&info, TRUE);
+
+        // CMYK/YCCK 不能直接输出 RGBA，交给 stb_image
+        if (info.jpeg_color_space == JCS_CMYK || info.jpeg_color_space == JCS_YCCK) {
+            jpeg_destroy_decompress(&info);
+            return nullptr;
+        }
+        info.out_color_space = JCS_EXT_RGBA;
+
+        if (minSize > 0) {
+            int longSide = static_cast<int>(std::max(info.image_width, info.image_height));
+            int denominator = 8;
+            while (denominator > 1 && (longSide + denominator - 1) / denominator < minSize) {
+                denominator /= 2;
+            }
+            // 缩小倍数太小时完整解码也足够快
+            if (denominator < 4) {
+                jpeg_destroy_decompress(&info);
+                return nullptr;
+            }
+            // 占位图只显示很短时间，换用更快的 IDCT 和上采样
+            info.scale_num = 1;
+            info.scale_denom = static_cast<unsigned int>(denominator);
+            info.dct_method = JDCT_IFAST;
+            info.do_fancy_upsampling = FALSE;
+        }
+        jpeg_start_decompress(&info);
+
+        int outputWidth = static_cast<int>(info.output_width);
+        int outputHeight = static_cast<int>(info.output_height);
+        pixels = AllocateImage(outputWidth, outputHeight);
+        if (!pixels) {
+            jpeg_destroy_decompress(&info);
+            return nullptr;
+        }
+
+        size_t stride = static_cast<size_t>(outputWidth) * 4;
+        JSAMPROW rows[ROWS_PER_READ];
+        while (info.output_scanline < info.output_height) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) {
+                jpeg_abort_decompress(&info);
+                jpeg_destroy_decompress(&info);
+                unsigned char* cancelled = pixels;
+                FreeImage(cancelled, "");
+                return nullptr;
+            }
+            int count = std::min<int>(ROWS_PER_READ, outputHeight - static_cast<int>(info.output_scanline));
+            for (int i = 0; i < count; ++i) {
+                rows[i] = pixels + (info.output_scanline + i) * stride;
+            }
+            jpeg_read_scanlines(&info, rows, count);
+        }
+
+        channels = info.num_components;
+        sourceWidth = static_cast<int>(info.image_width);
+        sourceHeight = static_cast<int>(info.image_height);
+        jpeg_finish_decompress(&info);
+        jpeg_destroy_decompress(&info);
+
+        width = outputWidth;
+        height = outputHeight;
+        return pixels;
+    }
+};
+}
+
+std::unique_ptr<ImageDecoder> CreateLibJpegDecoder() {
+    return std::make_unique<LibJpegDecoder>();
+}
+#endif
@@ -0,0 +1,318 @@
+#include "MappedFile.h"
+#include <filesystem>
+#include <utility>
+#include <algorithm>
+#include <new>
+#include <mutex>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <signal.h>
+    #include <cerrno>
+    #if defined(__linux__)
+        #include <sys/vfs.h>
+    #endif
+#endif
+
+namespace {
+// 网络文件每次读取的上限
+constexpr size_t READ_CHUNK = 4 * 1024 * 1024;
+
+// 当前线程受保护的映射范围，由异常 / 信号处理函数读取
+struct GuardState {
+    const unsigned char* begin = nullptr;
+    const unsigned char* end = nullptr;
+    bool faulted = false;
+};
+thread_local GuardState t_guard;
+
+void installFaultHandler();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_buffer = std::move(other.m_buffer);
+        m_damaged = std::exchange(other.m_damaged, false);
+#if defined(_WIN32)
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_replaced = std::exchange(other.m_replaced, false);
+#endif
+    }
+    return *this;
+}
+
+MappedReadGuard::MappedReadGuard(const MappedFile& file)
+    : m_file(file), m_active(file.isMapped()),
+      m_previousBegin(t_guard.begin), m_previousEnd(t_guard.end), m_previousFaulted(t_guard.faulted) {
+    if (!m_active) return;
+    installFaultHandler();
+    t_guard.begin = file.data();
+    t_guard.end = file.data() + file.size();
+    t_guard.faulted = false;
+}
+
+MappedReadGuard::~MappedReadGuard() {
+    if (!m_active) return;
+    if (t_guard.faulted) {
+        m_file.m_damaged = true;
+#if defined(_WIN32)
+        m_file.m_replaced = true;
+#endif
+    }
+    t_guard.begin = m_previousBegin;
+    t_guard.end = m_previousEnd;
+    t_guard.faulted = m_previousFaulted;
+}
+
+bool MappedReadGuard::failed() const {
+    return m_file.m_damaged || (m_active && t_guard.faulted);
+}
+
+#if defined(_WIN32)
+
+namespace {
+
+LONG CALLBACK handleInPageError(EXCEPTION_POINTERS* exception) {
+    const EXCEPTION_RECORD* record = exception->ExceptionRecord;
+    if (record->ExceptionCode != EXCEPTION_IN_PAGE_ERROR || record->NumberParameters < 2) {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+    auto address = reinterpret_cast<const unsigned char*>(record->ExceptionInformation[1]);
+    if (address < t_guard.begin || address >= t_guard.end) return EXCEPTION_CONTINUE_SEARCH;
+
+    // 视图不能按页替换：整体解除映射，在原地址分配同样大小的零页，由 close 释放
+    void* base = const_cast<unsigned char*>(t_guard.begin);
+    size_t size = static_cast<size_t>(t_guard.end - t_guard.begin);
+    if (!UnmapViewOfFile(base) || !VirtualAlloc(base, size, MEM_RESERVE | MEM_COMMIT, PAGE_READONLY)) {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+    t_guard.faulted = true;
+    return EXCEPTION_CONTINUE_EXECUTION;
+}
+
+void installFaultHandler() {
+    static std::once_flag once;
+    std::call_once(once, [] { AddVectoredExceptionHandler(1, handleInPageError); });
+}
+
+bool isRemotePath(const std::wstring& path) {
+    wchar_t volume[MAX_PATH];
+    if (!GetVolumePathNameW(path.c_str(), volume, MAX_PATH)) return false;
+    return GetDriveTypeW(volume) == DRIVE_REMOTE;
+}
+
+bool readRange(HANDLE file, unsigned char* out, size_t size) {
+    // 分段读取，每次请求有上限
+    size_t offset = 0;
+    while (offset < size) {
+        DWORD chunk = static_cast<DWORD>(std::min(size - offset, READ_CHUNK));
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+        DWORD read = 0;
+        if (!ReadFile(file, out + offset, chunk, &read, &position) || read == 0) return false;
+        offset += read;
+    }
+    return true;
+}
+
+} // namespace
+
+bool MappedFile::open(const std::string& path, size_t maxBytes) {
+    close();
+    // 与 fs::path::string() 使用同一编码转换，支持中文文件名
+    std::wstring widePath = std::filesystem::path(path).wstring();
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+    size_t size = static_cast<size_t>(std::min<uint64_t>(static_cast<uint64_t>(fileSize.QuadPart), maxBytes));
+    if (isRemotePath(widePath)) {
+        // 网络共享上的文件可能被远端改写，映射页面调入失败会抛出 EXCEPTION_IN_PAGE_ERROR
+        std::unique_ptr<unsigned char[]> buffer(new (std::nothrow) unsigned char[size]);
+        bool ok = buffer && readRange(file, buffer.get(), size);
+        CloseHandle(file);
+        if (!ok) return false;
+        m_buffer = std::move(buffer);
+        m_data = m_buffer.get();
+        m_size = size;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data && !m_buffer) {
+        if (m_replaced) {
+            VirtualFree(const_cast<unsigned char*>(m_data), 0, MEM_RELEASE);
+        } else {
+            UnmapViewOfFile(m_data);
+        }
+    }
+    m_buffer.reset();
+    if (m_mapping) {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+    }
+    if (m_file) {
+        CloseHandle(static_cast<HANDLE>(m_file));
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_damaged = false;
+    m_replaced = false;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+#else
+
+namespace {
+
+struct sigaction s_previousHandler;
+uintptr_t s_pageSize = 4096;
+
+void handleBusError(int signo, siginfo_t* info, void* context) {
+    auto address = static_cast<const unsigned char*>(info->si_addr);
+    if (address >= t_guard.begin && address < t_guard.end) {
+        // 文件已变短：缺失的页面换成零页，读取继续进行，调用者根据 failed() 丢弃结果
+        void* page = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(address) & ~(s_pageSize - 1));
+        if (mmap(page, s_pageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+            t_guard.faulted = true;
+            return;
+        }
+    }
+    // 不是受保护的读取，交给原来的处理方式；默认处理时恢复后返回，重新执行出错的指令终止进程
+    if ((s_previousHandler.sa_flags & SA_SIGINFO) && s_previousHandler.sa_sigaction) {
+        s_previousHandler.sa_sigaction(signo, info, context);
+    } else if (s_previousHandler.sa_handler != SIG_DFL && s_previousHandler.sa_handler != SIG_IGN) {
+        s_previousHandler.sa_handler(signo);
+    } else {
+        signal(SIGBUS, SIG_DFL);
+    }
+}
+
+void installFaultHandler() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        s_pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        struct sigaction action = {};
+        action.sa_sigaction = handleBusError;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &s_previousHandler);
+    });
+}
+
+bool isRemoteFileSystem(int fd) {
+#if defined(__linux__)
+    struct statfs info;
+    if (fstatfs(fd, &info) != 0) return false;
+    switch (static_cast<uint32_t>(info.f_type)) {
+    case 0x6969u:     // NFS
+    case 0x517Bu:     // SMB
+    case 0xFF534D42u: // CIFS
+    case 0xFE534D42u: // SMB2
+    case 0x65735546u: // FUSE（sshfs 等）
+    case 0x00C36400u: // Ceph
+        return true;
+    default:
+        return false;
+    }
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+bool readRange(int fd, unsigned char* out, size_t size) {
+    // 分段读取，每次请求有上限
+    size_t offset = 0;
+    while (offset < size) {
+        ssize_t count = ::pread(fd, out + offset, std::min(size - offset, READ_CHUNK), static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        offset += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+} // namespace
+
+bool MappedFile::open(const std::string& path, size_t maxBytes) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(std::min<uint64_t>(static_cast<uint64_t>(info.st_size), maxBytes));
+    if (isRemoteFileSystem(fd)) {
+        // 网络文件被远端改写时映射页面无法调入，进程会收到 SIGBUS
+        std::unique_ptr<unsigned char[]> buffer(new (std::nothrow) unsigned char[size]);
+        bool ok = buffer && readRange(fd, buffer.get(), size);
+        ::close(fd);
+        if (!ok) return false;
+        m_buffer = std::move(buffer);
+        m_data = m_buffer.get();
+        m_size = size;
+        return true;
+    }
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后即可关闭文件描述符
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    madvise(view, size, MADV_SEQUENTIAL);
+
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data && !m_buffer) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    m_buffer.reset();
+    m_data = nullptr;
+    m_size = 0;
+    m_damaged = false;
+}
+
+#endif
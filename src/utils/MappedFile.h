@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class MappedFile
+ * @brief 只读内存映射文件
+ * @description 一次打开，图像信息探测、EXIF 解析和解码共用同一份映射，
+ *              避免多次读取文件以及整文件拷贝到堆上。页面按需从磁盘调入。
+ *              网络共享上的文件被远端改写后访问映射会触发 SIGBUS / 页面错误，因此改为分段读入内存，
+ *              只需文件头的调用者用 maxBytes 限制读取范围
+ */
+class MappedFile {
+public:
+    static constexpr size_t WHOLE_FILE = SIZE_MAX;
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path, size_t maxBytes = WHOLE_FILE) { open(path, maxBytes); }
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 只访问文件开头至多 maxBytes 字节；空文件或无法映射时返回 false
+    bool open(const std::string& path, size_t maxBytes = WHOLE_FILE);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isMapped() const { return m_data != nullptr && !m_buffer; }
+
+private:
+    friend class MappedReadGuard;
+
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    std::unique_ptr<unsigned char[]> m_buffer; // 网络文件读入的内容，此时 m_data 指向这里
+    mutable bool m_damaged = false;            // 曾有页面读取失败，映射中的数据已不可信
+#if defined(_WIN32)
+    void* m_file = nullptr;     // HANDLE
+    void* m_mapping = nullptr;  // HANDLE
+    mutable bool m_replaced = false; // 视图已被换成零页（VirtualAlloc 分配）
+#endif
+};
+
+/**
+ * @class MappedReadGuard
+ * @brief 保护本线程在作用域内对映射的读取
+ * @description 映射后文件被截断（例如原地改写），读取超出新长度的页面会触发 SIGBUS，
+ *              Windows 上设备出错时为 EXCEPTION_IN_PAGE_ERROR。保护期间出错的页面换成零页继续执行，
+ *              读取结束后由 failed() 报告，调用者丢弃读到的数据。读入内存的文件不需要保护
+ */
+class MappedReadGuard {
+public:
+    explicit MappedReadGuard(const MappedFile& file);
+    ~MappedReadGuard();
+    MappedReadGuard(const MappedReadGuard&) = delete;
+    MappedReadGuard& operator=(const MappedReadGuard&) = delete;
+
+    // 读取过程中文件是否变短或无法读取
+    bool failed() const;
+
+private:
+    const MappedFile& m_file;
+    bool m_active;
+    const unsigned char* m_previousBegin;
+    const unsigned char* m_previousEnd;
+    bool m_previousFaulted;
+};
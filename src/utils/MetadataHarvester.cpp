@@ -0,0 +1,109 @@
+#include "MetadataHarvester.h"
+#include <iostream>
+#include <iterator>
+#include <chrono>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+// 降低当前线程的 CPU 和 I/O 优先级
+void lowerThreadPriority() {
+#if defined(_WIN32)
+    // 后台模式同时降低 CPU、I/O 和内存优先级
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined(__linux__)
+    // Linux 上 setpriority 只作用于调用线程
+    setpriority(PRIO_PROCESS, 0, 10);
+  #if defined(SYS_ioprio_set)
+    // IOPRIO_WHO_PROCESS，IOPRIO_CLASS_IDLE：磁盘空闲时才读取
+    constexpr int IOPRIO_WHO_PROCESS = 1;
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << 13);
+  #endif
+#endif
+}
+}
+
+MetadataHarvester::~MetadataHarvester() {
+    stop();
+}
+
+void MetadataHarvester::start(std::vector<Request> requests) {
+    stop();
+    if (requests.empty()) return;
+    m_requests = std::move(requests);
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread(&MetadataHarvester::workerThreadFunc, this);
+}
+
+void MetadataHarvester::stop() {
+    m_stopping = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running = false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.clear();
+}
+
+void MetadataHarvester::poll(std::vector<Result>& results) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (results.empty()) {
+        results.swap(m_results);
+    } else {
+        std::move(m_results.begin(), m_results.end(), std::back_inserter(results));
+        m_results.clear();
+    }
+}
+
+void MetadataHarvester::workerThreadFunc() {
+    lowerThreadPriority();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned char> buffer;
+    std::vector<Result> pending;
+    size_t read = 0, checked = 0;
+    for (auto& request : m_requests) {
+        if (m_stopping) break;
+        fs::path path = fs::u8path(request.path);
+        Result result;
+        std::error_code sizeError, timeError;
+        result.size = fs::file_size(path, sizeError);
+        result.modified = static_cast<int64_t>(fs::last_write_time(path, timeError).time_since_epoch().count());
+        if (request.known) {
+            ++checked;
+            // 文件未变时已有信息仍然有效；已删除的文件由目录监视处理
+            if (sizeError || timeError ||
+                (result.size == request.size && result.modified == request.modified)) {
+                continue;
+            }
+        }
+        if (sizeError) result.size = 0;
+        if (timeError) result.modified = 0;
+        result.valid = ReadImageHeader(path, result.info, buffer);
+        result.path = std::move(request.path);
+        pending.push_back(std::move(result));
+        ++read;
+        // 攒一批再交出，减少加锁次数
+        if (pending.size() >= 64) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::move(pending.begin(), pending.end(), std::back_inserter(m_results));
+            pending.clear();
+        }
+    }
+    if (!m_stopping) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::move(pending.begin(), pending.end(), std::back_inserter(m_results));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[MetadataHarvester] Read " << read << " headers, checked " << checked
+                  << " known files in " << seconds << " s" << std::endl;
+    }
+    m_requests.clear();
+    m_running = false;
+}
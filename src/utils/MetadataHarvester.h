@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "utils.h"
+
+/**
+ * @class MetadataHarvester
+ * @brief 后台读取列表中每张图片文件头里的尺寸、方向和拍摄时间
+ * @description 单个低优先级线程（Linux 上 I/O 也使用空闲级别），每个文件只读取开头
+ *              IMAGE_HEADER_WINDOW 字节，不解码像素，不与显示图片的解码争用资源。
+ *              主线程交入路径列表（当前图片附近的排在前面），每帧用 poll() 取回结果写入图片列表。
+ *              已有文件头信息的图片只比较大小和修改时间，原地改写过的才重新读取
+ *              （目录索引只按目录修改时间判断，原地改写文件不会改变目录的修改时间）
+ */
+class MetadataHarvester {
+public:
+    struct Request {
+        std::string path;       // UTF-8
+        uint64_t size = 0;      // 列表中记录的大小和修改时间
+        int64_t modified = 0;
+        bool known = false;     // 已有文件头信息，大小和修改时间不变时不再读取
+    };
+    struct Result {
+        std::string path;       // UTF-8
+        ImageHeaderInfo info;
+        bool valid = false;     // 无法读取或格式无法识别
+        uint64_t size = 0;      // 读取时的大小和修改时间
+        int64_t modified = 0;
+    };
+
+    MetadataHarvester() = default;
+    ~MetadataHarvester();
+    MetadataHarvester(const MetadataHarvester&) = delete;
+    MetadataHarvester& operator=(const MetadataHarvester&) = delete;
+
+    // 按 requests 的顺序读取，上一次未结束时先中止
+    void start(std::vector<Request> requests);
+    // 中止并等待线程退出
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+    // 取出上次调用以来读取的结果
+    void poll(std::vector<Result>& results);
+
+private:
+    void workerThreadFunc();
+
+    std::vector<Request> m_requests;
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_running{false};
+    std::mutex m_mutex;
+    std::vector<Result> m_results; // m_mutex 保护
+};
@@ -0,0 +1,157 @@
+#include "PixelPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// 头部保持 16 字节，返回给调用者的地址仍按 malloc 的方式对齐
+struct alignas(16) PixelPool::Header {
+    size_t capacity; // 可用字节数（大块为所属级别的尺寸）
+    size_t pooled;   // 非 0 时释放后回到池中
+};
+
+PixelPool& PixelPool::getInstance() {
+    // 不析构：其他静态对象（如线程池）在退出时仍可能释放像素
+    static PixelPool* instance = new PixelPool();
+    return *instance;
+}
+
+size_t PixelPool::sizeClass(size_t size) {
+    if (size < MIN_POOLED_BYTES) return size;
+    // 每个 2 的幂区间再分 4 级：2^n、1.25*2^n、1.5*2^n、1.75*2^n
+    int bit = 0;
+    while ((size >> (bit + 1)) != 0) ++bit;
+    size_t step = (static_cast<size_t>(1) << bit) / 4;
+    return (size + step - 1) / step * step;
+}
+
+int PixelPool::classIndex(size_t capacity) {
+    int bit = 0;
+    while ((capacity >> (bit + 1)) != 0) ++bit;
+    size_t step = (static_cast<size_t>(1) << bit) / 4;
+    return bit * 4 + static_cast<int>(capacity / step) - 4;
+}
+
+void* PixelPool::allocate(size_t size) {
+    if (size == 0) size = 1;
+    if (size >= MIN_POOLED_BYTES) {
+        return getInstance().allocateLarge(size);
+    }
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!header) return nullptr;
+    header->capacity = size;
+    header->pooled = 0;
+    return header + 1;
+}
+
+void* PixelPool::reallocate(void* pointer, size_t size) {
+    if (!pointer) return allocate(size);
+    Header* header = static_cast<Header*>(pointer) - 1;
+    if (size <= header->capacity) return pointer;
+    void* grown = allocate(size);
+    if (!grown) return nullptr;
+    std::memcpy(grown, pointer, header->capacity);
+    release(pointer);
+    return grown;
+}
+
+void PixelPool::release(void* pointer) {
+    if (!pointer) return;
+    Header* header = static_cast<Header*>(pointer) - 1;
+    if (header->pooled) {
+        getInstance().releaseLarge(header);
+    } else {
+        std::free(header);
+    }
+}
+
+void* PixelPool::allocateLarge(size_t size) {
+    size_t capacity = sizeClass(size);
+    int index = classIndex(capacity);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.allocations;
+        if (index < static_cast<int>(m_free.size()) && !m_free[index].empty()) {
+            Header* header = m_free[index].back();
+            m_free[index].pop_back();
+            ++m_stats.reused;
+            m_stats.retainedBytes -= capacity;
+            m_stats.inUseBytes += capacity;
+            m_stats.peakInUseBytes = std::max(m_stats.peakInUseBytes, m_stats.inUseBytes);
+            return header + 1;
+        }
+    }
+
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + capacity));
+    if (!header) {
+        // 系统内存不足时先归还池中的空闲块再试一次
+        trim();
+        header = static_cast<Header*>(std::malloc(sizeof(Header) + capacity));
+        if (!header) return nullptr;
+    }
+    header->capacity = capacity;
+    header->pooled = 1;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.systemAllocations;
+    m_stats.inUseBytes += capacity;
+    m_stats.peakInUseBytes = std::max(m_stats.peakInUseBytes, m_stats.inUseBytes);
+    return header + 1;
+}
+
+void PixelPool::releaseLarge(Header* header) {
+    size_t capacity = header->capacity;
+    int index = classIndex(capacity);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.inUseBytes -= capacity;
+        if (m_stats.retainedBytes + capacity <= m_retainLimit) {
+            if (index >= static_cast<int>(m_free.size())) {
+                m_free.resize(index + 1);
+            }
+            m_free[index].push_back(header);
+            m_stats.retainedBytes += capacity;
+            return;
+        }
+    }
+    std::free(header);
+}
+
+void PixelPool::trimTo(size_t bytes) {
+    // 先释放最大的块
+    for (int index = static_cast<int>(m_free.size()) - 1; index >= 0 && m_stats.retainedBytes > bytes; --index) {
+        auto& blocks = m_free[index];
+        while (!blocks.empty() && m_stats.retainedBytes > bytes) {
+            m_stats.retainedBytes -= blocks.back()->capacity;
+            std::free(blocks.back());
+            blocks.pop_back();
+        }
+    }
+}
+
+void PixelPool::setRetainLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_retainLimit = bytes;
+    trimTo(bytes);
+}
+
+void PixelPool::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    trimTo(0);
+}
+
+PixelPool::Stats PixelPool::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void PixelPool::printReport() {
+    Stats stats = getStats();
+    double reuseRate = stats.allocations ? 100.0 * stats.reused / stats.allocations : 0.0;
+    std::cout << "[PixelPool] allocations: " << stats.allocations
+              << ", reused: " << stats.reused << " (" << static_cast<int>(reuseRate + 0.5) << "%)"
+              << ", system allocations: " << stats.systemAllocations
+              << ", peak in use: " << stats.peakInUseBytes / (1024 * 1024) << " MB"
+              << ", in use: " << stats.inUseBytes / (1024 * 1024) << " MB"
+              << ", retained: " << stats.retainedBytes / (1024 * 1024) << " MB" << std::endl;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class PixelPool
+ * @brief 解码像素缓冲区的分级内存池
+ * @description stb_image（STBI_MALLOC/STBI_REALLOC/STBI_FREE）、stb_image_resize
+ *              以及 AllocateImage 都从这里分配。大块按尺寸分级（每个 2 的幂再分 4 级，
+ *              浪费不超过 25%），释放后留在池中给下一张图片复用，避免连续浏览时
+ *              反复向系统申请几十 MB 的内存；小块直接使用 malloc。
+ *              每块前有一个头部记录容量，任何线程都可以释放
+ */
+class PixelPool {
+public:
+    static constexpr size_t MIN_POOLED_BYTES = 256 * 1024;        // 更小的分配不进池
+    static constexpr size_t DEFAULT_RETAIN_BYTES = 256ull << 20;  // 池中最多保留的空闲内存
+
+    struct Stats {
+        uint64_t allocations = 0;   // 大块分配次数
+        uint64_t reused = 0;        // 其中由池中空闲块满足的次数
+        uint64_t systemAllocations = 0;
+        size_t inUseBytes = 0;      // 已分配、尚未释放的大块（按容量）
+        size_t peakInUseBytes = 0;
+        size_t retainedBytes = 0;   // 池中空闲块
+    };
+
+    static PixelPool& getInstance();
+
+    // 供 stb 宏使用，语义与 malloc/realloc/free 一致
+    static void* allocate(size_t size);
+    static void* reallocate(void* pointer, size_t size);
+    static void release(void* pointer);
+
+    void setRetainLimit(size_t bytes);
+    // 释放池中所有空闲块
+    void trim();
+    Stats getStats();
+    // 打印分配次数、复用率和峰值内存
+    void printReport();
+
+private:
+    struct Header;
+
+    PixelPool() = default;
+    PixelPool(const PixelPool&) = delete;
+    PixelPool& operator=(const PixelPool&) = delete;
+
+    static size_t sizeClass(size_t size);
+    static int classIndex(size_t capacity);
+    void* allocateLarge(size_t size);
+    void releaseLarge(Header* header);
+    void trimTo(size_t bytes); // 调用者持有 m_mutex
+
+    std::mutex m_mutex;
+    std::vector<std::vector<Header*>> m_free; // 按级别存放空闲块，后进先出
+    size_t m_retainLimit = DEFAULT_RETAIN_BYTES;
+    Stats m_stats;
+};
@@ -0,0 +1,227 @@
+#include "PreviewCache.h"
+#include "utils.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const char PREVIEW_MAGIC[4] = {'V', 'P', 'V', '1'};
+
+// FNV-1a 64 位哈希
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+}
+
+PreviewCache& PreviewCache::getInstance() {
+    static PreviewCache instance;
+    return instance;
+}
+
+fs::path PreviewCache::defaultDirectory() {
+    return getCacheDirectory("previews");
+}
+
+void PreviewCache::configure(bool enabled, const std::string& directory, int previewSize, size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = directory.empty() ? defaultDirectory() : fs::path(directory);
+    m_previewSize = std::max(64, previewSize);
+    m_budget = budgetBytes;
+    m_usedBytes = 0;
+    m_scanned = false;
+    m_enabled = false;
+    if (!enabled || m_budget == 0) return;
+
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (ec) {
+        std::cerr << "[PreviewCache] Failed to create " << m_directory << ": " << ec.message() << std::endl;
+        return;
+    }
+    m_enabled = true;
+    std::cout << "[PreviewCache] Using " << m_directory << std::endl;
+}
+
+bool PreviewCache::isEnabled() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_enabled;
+}
+
+int PreviewCache::getPreviewSize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_previewSize;
+}
+
+bool PreviewCache::makeCachePath(const fs::path& path, fs::path& cachePath) {
+    std::error_code ec;
+    auto fileSize = fs::file_size(path, ec);
+    if (ec) return false;
+    auto modified = fs::last_write_time(path, ec);
+    if (ec) return false;
+
+    fs::path directory;
+    int previewSize;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        directory = m_directory;
+        previewSize = m_previewSize;
+    }
+
+    // 文件被修改或预览尺寸变化后键随之改变，旧文件由 prune 清理
+    std::string pathString = path.generic_string();
+    int64_t modifiedTicks = static_cast<int64_t>(modified.time_since_epoch().count());
+    uint64_t size = static_cast<uint64_t>(fileSize);
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, pathString.data(), pathString.size());
+    hash = hashBytes(hash, &modifiedTicks, sizeof(modifiedTicks));
+    hash = hashBytes(hash, &size, sizeof(size));
+    hash = hashBytes(hash, &previewSize, sizeof(previewSize));
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vpv", static_cast<unsigned long long>(hash));
+    cachePath = directory / name;
+    return true;
+}
+
+unsigned char* PreviewCache::load(const fs::path& path, int& width, int& height, int& sourceWidth, int& sourceHeight) {
+    if (!isEnabled()) return nullptr;
+    fs::path cachePath;
+    if (!makeCachePath(path, cachePath)) return nullptr;
+
+    // 与图像解码一样映射读取；预览文件先写临时文件再改名，映射期间不会被原地改写
+    MappedFile file(cachePath.string());
+    if (!file.isOpen() || file.size() < sizeof(Header)) return nullptr;
+    // 缓存目录被其他程序截断文件时不至于 SIGBUS
+    MappedReadGuard guard(file);
+
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, PREVIEW_MAGIC, sizeof(PREVIEW_MAGIC)) != 0 ||
+        header.width == 0 || header.height == 0 || header.width > 16384 || header.height > 16384) {
+        return nullptr;
+    }
+
+    size_t bytes = static_cast<size_t>(header.width) * header.height * 4;
+    if (file.size() - sizeof(header) < bytes) {
+        // 写入中断留下的不完整文件
+        return nullptr;
+    }
+    unsigned char* data = AllocateImage(header.width, header.height);
+    if (!data) return nullptr;
+    std::memcpy(data, file.data() + sizeof(header), bytes);
+    if (guard.failed()) {
+        FreeImage(data, "");
+        return nullptr;
+    }
+    file.close();
+
+    // 更新修改时间，清理时优先保留最近使用的预览图
+    std::error_code ec;
+    fs::last_write_time(cachePath, fs::file_time_type::clock::now(), ec);
+
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    sourceWidth = static_cast<int>(header.sourceWidth);
+    sourceHeight = static_cast<int>(header.sourceHeight);
+    return data;
+}
+
+void PreviewCache::store(const fs::path& path, const unsigned char* data, int width, int height, int sourceWidth, int sourceHeight) {
+    if (!data || !isEnabled()) return;
+    int previewSize = getPreviewSize();
+    // 小图直接解码已经足够快
+    if (std::max(width, height) <= previewSize) return;
+
+    fs::path cachePath;
+    if (!makeCachePath(path, cachePath)) return;
+
+    double scale = static_cast<double>(previewSize) / std::max(width, height);
+    int previewWidth = std::max(1, static_cast<int>(width * scale + 0.5));
+    int previewHeight = std::max(1, static_cast<int>(height * scale + 0.5));
+    unsigned char* preview = ResizeImage(data, width, height, previewWidth, previewHeight);
+    if (!preview) return;
+
+    Header header;
+    std::memcpy(header.magic, PREVIEW_MAGIC, sizeof(PREVIEW_MAGIC));
+    header.width = static_cast<uint32_t>(previewWidth);
+    header.height = static_cast<uint32_t>(previewHeight);
+    header.sourceWidth = static_cast<uint32_t>(sourceWidth);
+    header.sourceHeight = static_cast<uint32_t>(sourceHeight);
+    size_t bytes = static_cast<size_t>(previewWidth) * previewHeight * 4;
+
+    // 先写临时文件再改名，其他线程不会读到写了一半的文件
+    fs::path tempPath = cachePath;
+    tempPath += ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        written = file &&
+                  file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                  file.write(reinterpret_cast<const char*>(preview), bytes);
+    }
+    FreeImage(preview, "");
+
+    std::error_code ec;
+    if (written) {
+        fs::rename(tempPath, cachePath, ec);
+    }
+    if (!written || ec) {
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_usedBytes += sizeof(header) + bytes;
+    if (!m_scanned || m_usedBytes > m_budget) {
+        prune();
+    }
+}
+
+void PreviewCache::prune() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type modified;
+        size_t size;
+    };
+    std::vector<Entry> entries;
+    size_t total = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".vpv") continue;
+        std::error_code entryError;
+        size_t size = static_cast<size_t>(it->file_size(entryError));
+        auto modified = it->last_write_time(entryError);
+        if (entryError) continue;
+        entries.push_back({it->path(), modified, size});
+        total += size;
+    }
+    m_usedBytes = total;
+    m_scanned = true;
+    if (m_usedBytes <= m_budget) return;
+
+    // 删除最旧的预览图，降到上限的 90% 以免每次写入都触发清理
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.modified < b.modified;
+    });
+    size_t target = m_budget / 10 * 9;
+    size_t removed = 0;
+    for (const auto& entry : entries) {
+        if (m_usedBytes <= target) break;
+        std::error_code removeError;
+        if (fs::remove(entry.path, removeError)) {
+            m_usedBytes -= std::min(m_usedBytes, entry.size);
+            ++removed;
+        }
+    }
+    std::cout << "[PreviewCache] Pruned " << removed << " previews, " << m_usedBytes / (1024 * 1024) << " MB left" << std::endl;
+}
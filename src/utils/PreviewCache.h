@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @class PreviewCache
+ * @brief 磁盘预览图缓存
+ * @description 每张图片保存一份缩小的 RGBA 预览图，按路径、修改时间和文件大小生成文件名，
+ *              文件内容为固定头部加未压缩的像素，读出后可直接上传纹理。
+ *              再次打开同一目录时先显示预览图，完整解码在后台继续进行。
+ *              总大小超出上限时按修改时间删除最旧的预览图
+ */
+class PreviewCache {
+public:
+    static PreviewCache& getInstance();
+
+    // directory 为空时使用系统缓存目录
+    void configure(bool enabled, const std::string& directory, int previewSize, size_t budgetBytes);
+    bool isEnabled();
+    int getPreviewSize();
+
+    // 命中时返回 STBI_MALLOC 分配的 RGBA 数据（使用 FreeImage 释放），未命中返回 nullptr
+    unsigned char* load(const fs::path& path, int& width, int& height, int& sourceWidth, int& sourceHeight);
+    // 将解码结果缩小到预览尺寸后写入缓存（在解码线程调用）
+    void store(const fs::path& path, const unsigned char* data, int width, int height, int sourceWidth, int sourceHeight);
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t width;
+        uint32_t height;
+        uint32_t sourceWidth;
+        uint32_t sourceHeight;
+    };
+
+    PreviewCache() = default;
+    PreviewCache(const PreviewCache&) = delete;
+    PreviewCache& operator=(const PreviewCache&) = delete;
+
+    // 由文件路径、修改时间和大小计算缓存文件路径，源文件不存在时返回 false
+    bool makeCachePath(const fs::path& path, fs::path& cachePath);
+    // 统计缓存目录并删除最旧的文件直到低于上限（调用者持有 m_mutex）
+    void prune();
+    static fs::path defaultDirectory();
+
+    std::mutex m_mutex;
+    bool m_enabled = false;
+    fs::path m_directory;
+    int m_previewSize = 512;
+    size_t m_budget = 0;
+    size_t m_usedBytes = 0;
+    bool m_scanned = false;
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include "DecodePool.h"
+
+/**
+ * @class SpscRing
+ * @brief 单生产者单消费者的无锁环形队列
+ * @description 容量固定（向上取 2 的幂），槽位预先构造，入队出队只移动元素，
+ *              不分配内存。只能有一个线程 push、一个线程 pop
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // 队列已满时返回 false，value 保持不变
+    bool push(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) return false;
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T(); // 尽早释放槽位持有的资源
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask = 0;
+    // 生产者和消费者各写一个计数器，分开放在不同的缓存行
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+/**
+ * @class UploadQueue
+ * @brief 解码线程把结果交给主线程（GL 线程）上传
+ * @description DecodePool 每个工作线程一条 SpscRing，主线程依次取出，
+ *              全程不加锁。同一工作线程提交的结果按提交顺序取出
+ */
+template <typename T>
+class UploadQueue {
+public:
+    static constexpr size_t RING_CAPACITY = 8; // 每个工作线程的槽位数
+
+    UploadQueue() {
+        size_t workers = DecodePool::getInstance().getWorkerCount();
+        m_rings.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            m_rings.push_back(std::make_unique<SpscRing<T>>(RING_CAPACITY));
+        }
+    }
+
+    /**
+     * @brief 提交一条上传记录（只能在 DecodePool 的工作线程调用）
+     * @description 队列已满时等待主线程取出，stop 置位后放弃。
+     *              等待期间不能持有主线程处理记录时需要的锁
+     * @return 未提交时返回 false，value 保持不变，由调用者释放
+     */
+    bool push(T& value, const std::atomic<bool>& stop) {
+        int worker = DecodePool::currentWorkerIndex();
+        if (worker < 0 || static_cast<size_t>(worker) >= m_rings.size()) return false;
+        SpscRing<T>& ring = *m_rings[worker];
+        while (!ring.push(value)) {
+            if (stop.load()) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // 取出所有记录（只能在主线程调用）
+    template <typename Handler>
+    void drain(Handler&& handler) {
+        T value;
+        for (auto& ring : m_rings) {
+            while (ring->pop(value)) {
+                handler(value);
+            }
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<SpscRing<T>>> m_rings;
+};
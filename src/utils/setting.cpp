@@ -84,6 +84,21 @@ void SettingManager::setBool(const std::string& section, const std::string& key,
     config[section][key] = value;
 }
 
+float SettingManager::getFloat(const std::string& section, const std::string& key, float defaultValue) {
+    try {
+        if (config.count(section) && config[section].count(key)) {
+            return config[section][key].as<float>();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error getting float: " << e.what() << std::endl;
+    }
+    return defaultValue;
+}
+
+void SettingManager::setFloat(const std::string& section, const std::string& key, float value) {
+    config[section][key] = value;
+}
+
 void SettingManager::initDefaultSettings() {
     // Display节默认配置
     setBool("Display", "image_cycle", true);
@@ -91,6 +106,17 @@ void SettingManager::initDefaultSettings() {
     setBool("Display", "image_EXIF", true);
     setBool("Display", "image_index", true);
     setBool("Display", "Enable_Exif_orientation", true);
+    setString("Display", "sort_mode", "path");
+
+    // Cache节默认配置
+    setInt("Cache", "prefetch_count", 2);
+    setInt("Cache", "cache_mb", 512);
+    setFloat("Cache", "zoom_headroom", 1.5f);
+    setBool("Cache", "disk_cache", true);
+    setString("Cache", "disk_cache_dir", "");
+    setInt("Cache", "preview_size", 512);
+    setInt("Cache", "disk_cache_mb", 2048);
+    setBool("Cache", "directory_index", true);
     
     saveSettings();
 }
@@ -131,6 +157,15 @@ void setSettingBool(const std::string& section, const std::string& key, bool val
     g_settings.setBool(section, key, value);
 }
 
+// 浮点值读写
+float getSettingFloat(const std::string& section, const std::string& key, float defaultValue) {
+    return g_settings.getFloat(section, key, defaultValue);
+}
+
+void setSettingFloat(const std::string& section, const std::string& key, float value) {
+    g_settings.setFloat(section, key, value);
+}
+
 // 初始化默认设置
 void initDefaultSetting() {
     g_settings.initDefaultSettings();
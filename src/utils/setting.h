@@ -44,6 +44,12 @@ public:
 
     // 设置布尔值
     void setBool(const std::string& section, const std::string& key, bool value);
+
+    // 获取浮点值
+    float getFloat(const std::string& section, const std::string& key, float defaultValue = 0.0f);
+
+    // 设置浮点值
+    void setFloat(const std::string& section, const std::string& key, float value);
     
     // 初始化默认设置
     void initDefaultSettings();
@@ -68,6 +74,10 @@ void setSettingInt(const std::string& section, const std::string& key, int value
 bool getSettingBool(const std::string& section, const std::string& key, bool defaultValue = true);
 void setSettingBool(const std::string& section, const std::string& key, bool value);
 
+// 浮点值读写
+float getSettingFloat(const std::string& section, const std::string& key, float defaultValue = 0.0f);
+void setSettingFloat(const std::string& section, const std::string& key, float value);
+
 // 初始化默认设置
 void initDefaultSetting();
 
@@ -1,10 +1,21 @@
 #include "utils.h"
+#include "DirectoryScanner.h"
+#include <climits>
 
 #define STBI_MAX_DIMENSIONS 32768  // 扩展到 32768x32768 ,默认最大支持尺寸为 ​16,777,216 像素
+// 解码和缩放的缓冲区从像素内存池分配，释放后给下一张图片复用
+#include "PixelPool.h"
+#define STBI_MALLOC(size) PixelPool::allocate(size)
+#define STBI_REALLOC(pointer, size) PixelPool::reallocate(pointer, size)
+#define STBI_FREE(pointer) PixelPool::release(pointer)
+#define STBIR_MALLOC(size, user_data) ((void)(user_data), PixelPool::allocate(size))
+#define STBIR_FREE(pointer, user_data) ((void)(user_data), PixelPool::release(pointer))
 // 需要包含 stb_image
 #define STB_IMAGE_IMPLEMENTATION
 // #include "stb_image.h"
 #include "stb_image.h" // 需先下载stb_image.h
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "stb_image_resize2.h" // x64 下自动启用 SSE2
 
 
 
@@ -20,37 +31,18 @@ bool getImageInfo(const std::string& filePath, int& w, int& h) {
         return false;
     }
 
-    // 打开文件并定位到末尾
-    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    // 映射文件头，只有被访问的页面会从磁盘读入
+    MappedFile file(filePath, IMAGE_HEADER_WINDOW);
+    if (!file.isOpen()) {
         std::cerr << "无法打开文件: " << filePath << std::endl;
         return false;
     }
 
-    // 检查文件大小是否有效
-    const long fileSize = file.tellg();
-    if (fileSize <= 0) {
-        std::cerr << "无效的文件大小: " << fileSize << std::endl;
-        file.close();
-        return false;
-    }
-
-    // 动态计算头部大小（上限2KB）
-    // 修改headerSize的计算逻辑
-    const size_t headerSize = (fileSize > 51768) ? 51768 : static_cast<size_t>(fileSize); // 32KB覆盖99%的EXIF偏移
-    file.seekg(0, std::ios::beg);
-
-    // 读取头部数据到vector（自动内存管理）
-    std::vector<unsigned char> header(headerSize);
-    if (!file.read(reinterpret_cast<char*>(header.data()), headerSize)) {
-        std::cerr << "读取文件头失败: " << filePath << std::endl;
-        file.close();
-        return false;
-    }
-    file.close();
+    const size_t headerSize = std::min(file.size(), IMAGE_HEADER_WINDOW);
 
     // 解析图像元数据
-    if (stbi_info_from_memory(header.data(), headerSize, &w, &h, &channels) == 0) {
+    MappedReadGuard guard(file);
+    if (stbi_info_from_memory(file.data(), static_cast<int>(headerSize), &w, &h, &channels) == 0 || guard.failed()) {
         std::cerr << "不支持的图像格式或损坏的文件: " << filePath << std::endl;
         return false;
     }
@@ -58,78 +50,21 @@ bool getImageInfo(const std::string& filePath, int& w, int& h) {
 }
 
 
-// 查找指定目录下的图片文件路径和文件名
+// 查找指定目录下的图片文件路径和文件名（多线程扫描，结果按路径排序）
 void find_image_files(
     const fs::path& directory, 
     std::vector<fs::path>& image_paths,
     std::vector<std::string>& image_names
 ) {
-    // 清空结果容器确保每次调用都是全新结果
+    ImageCatalog catalog;
+    DirectoryScanner::scan(directory, catalog);
     image_paths.clear();
     image_names.clear();
-
-    // 验证目录有效性 
-    if (!fs::exists(directory)) {
-        std::cerr << "错误：路径不存在 - " << directory << std::endl;
-        return;
-    }
-    if (!fs::is_directory(directory)) {
-        std::cerr << "错误：目标不是目录 - " << directory << std::endl;
-        return;
-    }
-
-    try {
-        // 创建递归迭代器
-        auto options = fs::directory_options::skip_permission_denied;
-        fs::recursive_directory_iterator dir_iter(directory, options);
-        fs::recursive_directory_iterator end_iter;
-
-        while (dir_iter != end_iter) {
-            try {
-                const auto& entry = *dir_iter;
-                
-                // 跳过非常规文件（目录/符号链接等）
-                if (entry.is_regular_file()) {
-                    // 获取小写扩展名以统一比较
-                    std::string ext = entry.path().extension().string();
-                    std::transform(ext.begin(), ext.end(), ext.begin(), 
-                                  [](unsigned char c) { return std::tolower(c); });
-                    
-                    // 检查是否为图片格式 
-                    if (imageExtensions.find(ext) != imageExtensions.end() && std::filesystem::exists(entry.path())) {
-                       
-                       
-                        try{
-                            std::string filePath = entry.path().generic_string();
-                            image_paths.push_back(entry.path());
-                            image_names.push_back(entry.path().filename().u8string());
-
-                        }
-                        catch (const std::exception& e) {
-                            std::cerr << entry.path() <<"  -------: " << std::endl;
-                     
-                        }
-                        
-
-                    }
-                }
-                ++dir_iter;
-            } 
-            // 捕获单个文件处理中的异常（不影响整体遍历）
-            catch (const fs::filesystem_error& e) {
-                std::cerr << "跳过无法访问的文件: " << e.what() << std::endl;
-                dir_iter.disable_recursion_pending();  // 继续遍历其他文件 [7](@ref)
-                ++dir_iter;
-            }
-        }
-    } 
-    // 捕获全局性异常（如目录打开失败）
-    catch (const fs::filesystem_error& e) {
-        std::cerr << "文件系统错误: " << e.what() << std::endl;
-
-    }
-    catch (const std::exception& e) {
-        std::cerr << "未知错误: " << e.what() << std::endl;
+    image_paths.reserve(catalog.size());
+    image_names.reserve(catalog.size());
+    for (size_t i = 0; i < catalog.size(); ++i) {
+        image_paths.push_back(catalog.path(i));
+        image_names.push_back(catalog.name(i));
     }
 }
 
@@ -194,6 +129,14 @@ bool isGifPath(const std::string& path) {
     return fs::path(path).extension() == ".gif";
 }
 
+bool hasImageExtension(const fs::path& path) {
+    // 获取小写扩展名以统一比较
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return imageExtensions.find(ext) != imageExtensions.end();
+}
+
 bool isDirectory(const std::string& path) {
     try {
         return fs::is_directory(path);
@@ -221,6 +164,23 @@ std::string getDirectoryFromPath(const std::string& path) {
     }
 }
 
+fs::path getCacheDirectory(const std::string& name) {
+#if defined(_WIN32)
+    if (const char* localAppData = std::getenv("LOCALAPPDATA")) {
+        return fs::path(localAppData) / "Vimag" / name;
+    }
+#else
+    if (const char* xdgCache = std::getenv("XDG_CACHE_HOME")) {
+        return fs::path(xdgCache) / "vimag" / name;
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return fs::path(home) / ".cache" / "vimag" / name;
+    }
+#endif
+    std::error_code ec;
+    return fs::temp_directory_path(ec) / ("vimag-" + name);
+}
+
 
 
 void getImages( const std::string& filePath,fs::path& directory,std::vector<fs::path>& image_paths, std::vector<std::string>& image_names,size_t& current_index ){
@@ -236,105 +196,340 @@ void getImages( const std::string& filePath,fs::path& directory,std::vector<fs::
 }
 //////////////////////////////  gif   //////////////////////////////////////////
 unsigned char* loadGifImage(const std::string& path, int& outWidth, int& outHeight, int& channels, int& frames,std::vector<int>& outDelays) { 
-    // 1. 读取文件到内存 
-    std::ifstream file(path, std::ios::binary | std::ios::ate); 
-    if (!file.is_open()) { 
+    // 1. 映射文件，直接从映射内存解码
+    MappedFile file(path);
+    if (!file.isOpen()) { 
         std::cerr << "Failed to open GIF: " << path << std::endl; 
         return nullptr;  // 修正：返回nullptr而不是false
     } 
+    // stb_image 以 int 表示数据长度
+    if (file.size() >= static_cast<size_t>(INT_MAX)) {
+        std::cerr << "GIF too large: " << path << std::endl;
+        return nullptr;
+    }
     
-    size_t size = file.tellg(); 
-    file.seekg(0); 
-    std::vector<char> buffer(size); 
-    file.read(buffer.data(), size); 
-    
+    // 解码期间文件被截断时读到的是零页，结果丢弃
+    MappedReadGuard guard(file);
     int* delays = nullptr;
     unsigned char* data = nullptr;  // 初始化为nullptr
     
     try { 
         // 2. 使用stb_image加载GIF 
         data = stbi_load_gif_from_memory( 
-            reinterpret_cast<unsigned char*>(buffer.data()), 
-            static_cast<int>(size), 
+            file.data(), 
+            static_cast<int>(file.size()), 
             &delays, &outWidth, &outHeight, &frames, &channels, 0); 
 
         // 直接使用参数引用，不需要局部变量
         std::cout << "GIF width: " << outWidth << ", height: " << outHeight 
                   << ", frames: " << frames << ", channels: " << channels << std::endl; 
         
+        if (data && guard.failed()) {
+            std::cerr << "GIF changed while decoding: " << path << std::endl;
+            stbi_image_free(data);
+            data = nullptr;
+        }
         if (!data) { 
             std::cerr << "Failed to load GIF: " << stbi_failure_reason() << std::endl; 
-            if (delays) free(delays);  // 清理delays
+            if (delays) STBI_FREE(delays);  // 清理delays
             return nullptr; 
         } 
         
         // 将C数组复制到vector中
         if (delays && frames > 0) {
             outDelays.assign(delays, delays + frames);
-            free(delays); // 释放stbi分配的内存
+            STBI_FREE(delays); // 释放stbi分配的内存
         }
 
         return data; 
     } catch (const std::bad_alloc& e) { 
         std::cerr << "Memory allocation failed: " << e.what() << std::endl; 
-        if (delays) free(delays);  // 安全清理
+        if (delays) STBI_FREE(delays);  // 安全清理
         if (data) stbi_image_free(data);  // 安全清理
         return nullptr; 
     } 
 }
 
 
+////////////////////////////////   GIF stream   ///////////////////////////////
+// 逐帧解码 GIF，stb_image 的逐帧接口只在实现所在的编译单元可见
+struct GifFrameReader {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    stbi__context context;
+    stbi__gif gif;
+    // 前一帧、前两帧的合成结果，处置方式为“恢复到前一状态”时需要前两帧
+    std::vector<unsigned char> history[2];
+    FrameRect previousRect; // 上一帧的图像描述符区域
+    int frames = 0; // 本轮已解码的帧数
+};
+
+static void resetGifReader(GifFrameReader* reader) {
+    STBI_FREE(reader->gif.out);
+    STBI_FREE(reader->gif.history);
+    STBI_FREE(reader->gif.background);
+    memset(&reader->gif, 0, sizeof(reader->gif));
+    stbi__start_mem(&reader->context, reader->data, static_cast<int>(reader->size));
+    reader->frames = 0;
+}
+
+GifFrameReader* OpenGifReader(const unsigned char* data, size_t size) {
+    if (!data || size > static_cast<size_t>(INT_MAX)) return nullptr;
+    stbi__context context;
+    stbi__start_mem(&context, data, static_cast<int>(size));
+    if (!stbi__gif_test(&context)) return nullptr;
+
+    // stbi__gif 含 8192 项的 LZW 表，放在堆上
+    GifFrameReader* reader = new GifFrameReader();
+    reader->data = data;
+    reader->size = size;
+    memset(&reader->gif, 0, sizeof(reader->gif));
+    resetGifReader(reader);
+    return reader;
+}
+
+const unsigned char* ReadGifFrame(GifFrameReader* reader, int& width, int& height, int& delay, FrameRect* changed) {
+    if (!reader) return nullptr;
+    unsigned char* twoBack = reader->frames >= 2 ? reader->history[1].data() : nullptr;
+    int components = 0;
+    stbi_uc* frame = stbi__gif_load_next(&reader->context, &reader->gif, &components, 4, twoBack);
+    // 返回 context 本身表示已读到结束标记
+    if (!frame || frame == reinterpret_cast<stbi_uc*>(&reader->context)) return nullptr;
+
+    width = reader->gif.w;
+    height = reader->gif.h;
+    delay = reader->gif.delay;
+
+    // stb 以字节偏移记录本帧的图像描述符：x 方向每像素 4 字节，y 方向每行 line_size 字节
+    const stbi__gif& gif = reader->gif;
+    FrameRect rect;
+    if (gif.line_size > 0) {
+        rect.x = gif.start_x / 4;
+        rect.y = gif.start_y / gif.line_size;
+        rect.width = (gif.max_x - gif.start_x) / 4;
+        rect.height = (gif.max_y - gif.start_y) / gif.line_size;
+    }
+    if (changed) {
+        if (reader->frames == 0) {
+            *changed = FrameRect{0, 0, width, height};
+        } else {
+            // 上一帧的处置（恢复背景或前一状态）只改动上一帧的区域
+            const FrameRect& previous = reader->previousRect;
+            int left = std::min(rect.x, previous.x);
+            int top = std::min(rect.y, previous.y);
+            int right = std::max(rect.x + rect.width, previous.x + previous.width);
+            int bottom = std::max(rect.y + rect.height, previous.y + previous.height);
+            *changed = FrameRect{left, top, right - left, bottom - top};
+        }
+    }
+    reader->previousRect = rect;
+
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    std::swap(reader->history[0], reader->history[1]);
+    reader->history[0].assign(frame, frame + bytes);
+    ++reader->frames;
+    return frame;
+}
+
+void RewindGifReader(GifFrameReader* reader) {
+    if (reader) resetGifReader(reader);
+}
+
+void CloseGifReader(GifFrameReader* reader) {
+    if (!reader) return;
+    STBI_FREE(reader->gif.out);
+    STBI_FREE(reader->gif.history);
+    STBI_FREE(reader->gif.background);
+    delete reader;
+}
+
 ////////////////////////////////   image   ///////////////////////////////
-unsigned char* LoadImage(const std::string& path, int& outWidth, int& outHeight, int& channels, int desiredChannels) {
-    // 检查文件是否存在
-    if (!std::filesystem::exists(path)) {
+unsigned char* LoadImage(const std::string& path, int& outWidth, int& outHeight, int& channels, int desiredChannels, const std::atomic<bool>* cancel) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
         std::cerr << "Error: Image file not found: " << path << std::endl;
         return nullptr;
     }
-    
-    // 先尝试获取图像信息
-    if (!stbi_info(path.c_str(), &outWidth, &outHeight, &channels)) {
-        std::cerr << "Failed to get image info: " << path << std::endl;
-        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+    return LoadImage(file, path, outWidth, outHeight, channels, desiredChannels, cancel);
+}
+
+unsigned char* LoadImage(const MappedFile& file, const std::string& path, int& outWidth, int& outHeight, int& channels, int desiredChannels, const std::atomic<bool>* cancel) {
+    if (!file.isOpen()) {
+        std::cerr << "Error: Image file not readable: " << path << std::endl;
         return nullptr;
     }
-    
+    // 映射后被截断的文件，解码读到文件末尾之外时换成零页，解码结果丢弃
+    MappedReadGuard guard(file);
+
+    // 按文件头选择解码器，GIF 由 AnimatedImage 播放；APNG 在这里解码默认图像
+    ImageFormat format = DetectImageFormat(file.data(), file.size());
+    if (format == ImageFormat::GIF) {
+        return nullptr;
+    }
+
     std::cout << "Loading image: " << path << std::endl;
     unsigned char* outData = nullptr;
-
-    if (!isGifPath(path)) {
-        try {
-            outData = stbi_load(path.c_str(), &outWidth, &outHeight, &channels, desiredChannels);
-            if (!outData) {
-                std::cerr << "Failed to load image: " << path << std::endl;
-                std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
-                return nullptr;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Failed to load image: " << e.what() << std::endl;
-            return nullptr;
+    try {
+        outData = ImageDecoderRegistry::getInstance().decode(file.data(), file.size(), outWidth, outHeight, channels, desiredChannels, cancel);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Failed to load image: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (outData && guard.failed()) {
+        std::cerr << "Error: Image file changed while decoding: " << path << std::endl;
+        FreeImage(outData, path);
+        return nullptr;
+    }
+    if (!outData) {
+        if (cancel && cancel->load()) {
+            std::cout << "Decode cancelled: " << path << std::endl;
+        } else {
+            std::cerr << "Failed to load image: " << path << std::endl;
         }
-    } else {
-        // try {
-        //     int frame_count;
-        //     GifImage gif = loadGif(path, outWidth, outHeight, frame_count);
-        //     if (gif.frame_count > 0 && gif.frames) {
-        //         size_t frameSize = gif.width * gif.height * 4;
-        //         outData = new unsigned char[frameSize];
-        //         memcpy(outData, gif.frames.get()+ 60 * frameSize, frameSize);
-        //     } else {
-        //         std::cerr << "Failed to load GIF: " << path << std::endl;
-        //         return nullptr;
-        //     }
-        // } catch (const std::exception& e) {
-        //     std::cerr << "Error: Failed to load GIF: " << e.what() << std::endl;
-        //     return nullptr;
-        // }
     }
-
     return outData;
 }
 
+ImageLoadResult OpenImage(const std::string& path, int desiredChannels, const std::atomic<bool>* cancel, bool apngFallback) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        std::cerr << "Error: Image file not found: " << path << std::endl;
+        return ImageLoadResult();
+    }
+    return OpenImage(file, path, desiredChannels, cancel, apngFallback);
+}
+
+ImageLoadResult OpenImage(const MappedFile& file, const std::string& path, int desiredChannels,
+                          const std::atomic<bool>* cancel, bool apngFallback) {
+    ImageLoadResult result;
+    if (!file.isOpen()) return result;
+    MappedReadGuard guard(file);
+    result.format = DetectImageFormat(file.data(), file.size());
+    result.animated = result.format == ImageFormat::GIF || IsAnimatedPng(file.data(), file.size());
+    if (result.animated && !(apngFallback && result.format == ImageFormat::PNG)) return result;
+    result.pixels = LoadImage(file, path, result.width, result.height, result.channels, desiredChannels, cancel);
+    if (result.pixels) {
+        // EXIF 位于文件头部，对应的页面在解码时已经读入
+        result.metadata = ReadImageMetadata(file);
+    }
+    return result;
+}
+
+unsigned char* LoadExifThumbnail(const MappedFile& file, int& width, int& height, int& sourceWidth, int& sourceHeight) {
+    const unsigned char* thumbnail = nullptr;
+    size_t length = 0;
+    if (!file.isOpen()) return nullptr;
+    MappedReadGuard guard(file);
+    if (!EXIF::findThumbnail(file.data(), file.size(), thumbnail, length)) {
+        return nullptr;
+    }
+    int channels = 0;
+    if (!stbi_info_from_memory(file.data(), static_cast<int>(std::min(file.size(), static_cast<size_t>(INT_MAX))),
+                               &sourceWidth, &sourceHeight, &channels)) {
+        return nullptr;
+    }
+    unsigned char* pixels = ImageDecoderRegistry::getInstance().decode(thumbnail, length, width, height, channels, 4);
+    if (!pixels) return nullptr;
+    if (guard.failed()) {
+        FreeImage(pixels, "");
+        return nullptr;
+    }
+
+    // 部分相机固定输出 4:3 缩略图并在上下加黑边，拉伸后与原图不符
+    double sourceAspect = static_cast<double>(sourceWidth) / sourceHeight;
+    double aspect = static_cast<double>(width) / height;
+    if (std::abs(aspect - sourceAspect) > sourceAspect * 0.03) {
+        FreeImage(pixels, "");
+        return nullptr;
+    }
+    return pixels;
+}
+
+bool ReadImageSize(const MappedFile& file, int& width, int& height) {
+    int channels = 0;
+    if (!file.isOpen()) return false;
+    MappedReadGuard guard(file);
+    return stbi_info_from_memory(file.data(), static_cast<int>(std::min(file.size(), static_cast<size_t>(INT_MAX))),
+                                 &width, &height, &channels) &&
+           !guard.failed();
+}
+
+ImageMetadata ReadImageMetadata(const MappedFile& file) {
+    ImageMetadata metadata;
+    metadata.exifValid = getExifInfo(file, metadata.exifSummary, metadata.orientation);
+    return metadata;
+}
+
+ImageMetadata ReadImageMetadata(const std::string& path) {
+    MappedFile file(path, EXIF_WINDOW);
+    return ReadImageMetadata(file);
+}
+
+unsigned char* AllocateImage(int width, int height) {
+    return static_cast<unsigned char*>(STBI_MALLOC(static_cast<size_t>(width) * height * 4));
+}
+
+unsigned char* ResizeImage(const unsigned char* data, int width, int height, int newWidth, int newHeight) {
+    // 输出缓冲区与 stb_image 使用同一分配器，调用者仍可用 FreeImage 释放
+    unsigned char* resized = AllocateImage(newWidth, newHeight);
+    if (!resized) {
+        return nullptr;
+    }
+    if (!stbir_resize_uint8_srgb(data, width, height, 0, resized, newWidth, newHeight, 0, STBIR_RGBA)) {
+        STBI_FREE(resized);
+        return nullptr;
+    }
+    return resized;
+}
+
+bool ResizeImageToFit(unsigned char*& data, int& width, int& height, int maxWidth, int maxHeight) {
+    if (!data || maxWidth <= 0 || maxHeight <= 0 || (width <= maxWidth && height <= maxHeight)) {
+        return false;
+    }
+
+    double scale = std::min(static_cast<double>(maxWidth) / width, static_cast<double>(maxHeight) / height);
+    int newWidth = std::max(1, static_cast<int>(width * scale + 0.5));
+    int newHeight = std::max(1, static_cast<int>(height * scale + 0.5));
+
+    unsigned char* resized = ResizeImage(data, width, height, newWidth, newHeight);
+    if (!resized) {
+        return false;
+    }
+
+    stbi_image_free(data);
+    data = resized;
+    width = newWidth;
+    height = newHeight;
+    return true;
+}
+
+std::vector<ImageLevel> BuildImagePyramid(const unsigned char* data, int width, int height, int minSize) {
+    std::vector<ImageLevel> levels;
+    const unsigned char* source = data;
+    int sourceWidth = width;
+    int sourceHeight = height;
+    // 每一级由上一级缩小一半，总开销约为原图的 1/3
+    while (source && std::max(sourceWidth, sourceHeight) > minSize) {
+        ImageLevel level;
+        level.width = std::max(1, sourceWidth / 2);
+        level.height = std::max(1, sourceHeight / 2);
+        level.data = ResizeImage(source, sourceWidth, sourceHeight, level.width, level.height);
+        if (!level.data) break;
+        levels.push_back(level);
+        source = level.data;
+        sourceWidth = level.width;
+        sourceHeight = level.height;
+    }
+    return levels;
+}
+
+void FreeImageLevels(std::vector<ImageLevel>& levels) {
+    for (auto& level : levels) {
+        stbi_image_free(level.data);
+    }
+    levels.clear();
+}
+
 // 修改函数定义
 void FreeImage(unsigned char*& data, const std::string& path) {
     if (!data) return;
@@ -383,11 +578,99 @@ int get_Orientation(int orientation){
     }
 }
 
-bool getExifInfo(const std::string& imagPath,std::string& image_exif,int& orientation){
+namespace {
+// WebP 的画布尺寸（stb_image 不支持 WebP）
+bool readWebpSize(const unsigned char* data, size_t size, int& width, int& height) {
+    if (size < 30) return false;
+    const unsigned char* chunk = data + 12;
+    if (std::memcmp(chunk, "VP8X", 4) == 0) {
+        width = 1 + (data[24] | (data[25] << 8) | (data[26] << 16));
+        height = 1 + (data[27] | (data[28] << 8) | (data[29] << 16));
+    } else if (std::memcmp(chunk, "VP8L", 4) == 0) {
+        uint32_t bits = data[21] | (data[22] << 8) | (data[23] << 16) | (static_cast<uint32_t>(data[24]) << 24);
+        width = 1 + (bits & 0x3FFF);
+        height = 1 + ((bits >> 14) & 0x3FFF);
+    } else if (std::memcmp(chunk, "VP8 ", 4) == 0) {
+        width = (data[26] | (data[27] << 8)) & 0x3FFF;
+        height = (data[28] | (data[29] << 8)) & 0x3FFF;
+    } else {
+        return false;
+    }
+    return width > 0 && height > 0;
+}
+}
+
+bool ReadImageHeader(const fs::path& path, ImageHeaderInfo& info, std::vector<unsigned char>& buffer) {
+    info = ImageHeaderInfo();
+    // 只读取开头一段，不映射整个文件，扫描大量文件时 I/O 有上限
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return false;
+    buffer.resize(IMAGE_HEADER_WINDOW);
+    input.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    size_t size = static_cast<size_t>(input.gcount());
+    if (size == 0) return false;
+    const unsigned char* data = buffer.data();
+
+    info.format = DetectImageFormat(data, size);
+    int channels = 0;
+    if (info.format == ImageFormat::WEBP) {
+        readWebpSize(data, size, info.width, info.height);
+    } else if (!stbi_info_from_memory(data, static_cast<int>(size), &info.width, &info.height, &channels)) {
+        info.width = info.height = 0;
+        // TGA 没有魔数，stb_image 也无法识别时视为不支持
+        if (info.format == ImageFormat::Unknown) return false;
+    }
+
+    if (info.format == ImageFormat::JPEG) {
+        TinyEXIF::EXIFInfo exif;
+        if (exif.parseFrom(data, static_cast<unsigned>(size)) == TinyEXIF::PARSE_SUCCESS) {
+            info.orientation = get_Orientation(exif.Orientation);
+            info.captureTime = ParseExifDateTime(exif.DateTimeOriginal);
+            if (info.captureTime == 0) {
+                info.captureTime = ParseExifDateTime(exif.DateTime);
+            }
+            // SOF 在读取范围之后时使用 EXIF 中记录的尺寸
+            if (info.width == 0 && exif.ImageWidth > 0 && exif.ImageHeight > 0) {
+                info.width = static_cast<int>(exif.ImageWidth);
+                info.height = static_cast<int>(exif.ImageHeight);
+            }
+        }
+    }
+    return true;
+}
+
+int64_t ParseExifDateTime(const std::string& text) {
+    int year, month, day, hour, minute, second;
+    if (std::sscanf(text.c_str(), "%d:%d:%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6 ||
+        year <= 0 || month < 1 || month > 12 || day < 1 || day > 31) {
+        return 0;
+    }
+    // 公历日期到 1970-01-01 的天数
+    int y = year - (month <= 2 ? 1 : 0);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = static_cast<int64_t>(era) * 146097 + dayOfEra - 719468;
+    return days * 86400 + hour * 3600 + minute * 60 + second;
+}
 
+bool getExifInfo(const std::string& imagPath,std::string& image_exif,int& orientation){
+    MappedFile file(imagPath, EXIF_WINDOW);
+    return getExifInfo(file, image_exif, orientation);
+}
 
-    EXIF exif(imagPath);
-    if (!exif.isValid()) {
+bool getExifInfo(const MappedFile& file,std::string& image_exif,int& orientation){
+    // 只需要 APP1 段，不必映射之后的像素数据
+    size_t size = std::min(file.size(), EXIF_WINDOW);
+    bool valid = false;
+    EXIF exif;
+    if (file.isOpen()) {
+        MappedReadGuard guard(file);
+        exif.parse(file.data(), size);
+        valid = exif.isValid() && !guard.failed();
+    }
+    if (!valid) {
         // std::cerr << "EXIF信息无效: " << imagPath << std::endl;
         image_exif = "EXIF info is invalid";
         orientation = 0;
@@ -9,7 +9,11 @@
 #include <cstdlib>
 #include <iostream> // \以包含 std::cout 和 std::cerr
 #include <cstring> // 包含 std::strerror 函数的头文件
+#include <atomic>
+#include <chrono>
 #include "../TinyEXIF/EXIF.h" 
+#include "MappedFile.h"
+#include "ImageDecoder.h"
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -21,10 +25,15 @@ static const std::set<std::string> imageExtensions = {
 };
 
 
+// 读取文件头的上限，覆盖绝大多数 EXIF 偏移
+constexpr size_t IMAGE_HEADER_WINDOW = 51768;
+// EXIF 所在的 APP1 段不超过 64KB，只读取元数据时读到这里为止，网络文件不必整个读入
+constexpr size_t EXIF_WINDOW = 128 * 1024;
+
 bool getImageInfo(const std::string& filePath, int& w, int& h) ;
 
 
-// 查找指定目录下的图片文件路径和文件名
+// 查找指定目录下的图片文件路径和文件名（结果按路径排序）
 void find_image_files( const fs::path& directory, std::vector<fs::path>& image_paths,std::vector<std::string>& image_names) ;
 
 size_t findPathIndex(const std::vector<fs::path>& paths, const fs::path& target) ;
@@ -33,8 +42,12 @@ void removeZero(std::string& str);
 std::string fomatExposureTime(double& exposureTime) ;
 bool isFile(const std::string& path) ;
 bool isGifPath(const std::string& path);
+// 扩展名（不区分大小写）是否为支持的图片格式
+bool hasImageExtension(const fs::path& path);
 bool isDirectory(const std::string& path) ;
 std::string getDirectoryFromPath(const std::string& path) ;
+// 程序缓存目录下的子目录（不会自动创建）
+fs::path getCacheDirectory(const std::string& name);
 
 void getImages( const std::string& filePath,fs::path& directory,std::vector<fs::path>& image_paths, std::vector<std::string>& image_names,size_t& current_index );
 
@@ -103,10 +116,108 @@ public:
      * @param outWidth 输出图像宽度
      * @param outHeight 输出图像高度
      * @param desiredChannels 期望的通道数（0=原样,1=灰度,3=RGB,4=RGBA）
+     * @param cancel 取消标记，置位后停止读取文件并返回 nullptr
      * @return 是否加载成功
      */
 // bool LoadImage(const std::string& path, unsigned char** outData,  int* outWidth,  int* outHeight);
-unsigned char* LoadImage(const std::string& path,  int& outWidth, int& outHeight, int& channels ,int desiredChannels = 4); 
+unsigned char* LoadImage(const std::string& path,  int& outWidth, int& outHeight, int& channels ,int desiredChannels = 4, const std::atomic<bool>* cancel = nullptr); 
+// 从已映射的文件解码，按文件头选择解码器（path 仅用于日志）
+unsigned char* LoadImage(const MappedFile& file, const std::string& path, int& outWidth, int& outHeight, int& channels, int desiredChannels = 4, const std::atomic<bool>* cancel = nullptr);
+
+// 标签显示和自动旋转所需的图像元数据
+struct ImageMetadata {
+    bool exifValid = false;
+    int orientation = 0;                              // 旋转角度（0/90/180/-90）
+    std::string exifSummary = "EXIF info is invalid"; // 标签中显示的 EXIF 摘要
+};
+
+// 只读取文件头得到的信息，不解码像素
+struct ImageHeaderInfo {
+    ImageFormat format = ImageFormat::Unknown;
+    int width = 0;              // 0 表示文件头中没有（例如 SOF 在读取范围之后）
+    int height = 0;
+    int orientation = 0;        // 旋转角度（0/90/180/-90）
+    int64_t captureTime = 0;    // EXIF 拍摄时间（秒），0 表示没有
+};
+  /**
+     * @brief 读取文件开头至多 IMAGE_HEADER_WINDOW 字节，解析格式、尺寸、方向和拍摄时间
+     * @param buffer 读取用的缓冲区，连续读取多个文件时复用
+     * @return 无法打开或格式无法识别时返回 false
+     */
+bool ReadImageHeader(const fs::path& path, ImageHeaderInfo& info, std::vector<unsigned char>& buffer);
+// EXIF 日期 "YYYY:MM:DD HH:MM:SS" 转为秒（按 UTC 换算，只用于比较先后），无法解析时返回 0
+int64_t ParseExifDateTime(const std::string& text);
+
+// 一次打开文件得到的像素、尺寸和元数据
+struct ImageLoadResult {
+    unsigned char* pixels = nullptr; // 使用 FreeImage 释放
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    ImageFormat format = ImageFormat::Unknown; // 按文件头识别
+    bool animated = false;                     // GIF/APNG 不在这里解码，由 AnimatedImage 播放
+    ImageMetadata metadata;
+};
+
+  /**
+     * @brief 打开图像：映射文件一次，信息探测、EXIF 解析和解码共用这份映射
+     * @param cancel 取消标记，置位后停止解码并返回空结果
+     * @param apngFallback APNG 无法播放时为 true，解码其默认图像
+     */
+ImageLoadResult OpenImage(const std::string& path, int desiredChannels = 4, const std::atomic<bool>* cancel = nullptr,
+                          bool apngFallback = false);
+// 使用已打开的文件（例如先用于分块探测），不再重复读取
+ImageLoadResult OpenImage(const MappedFile& file, const std::string& path, int desiredChannels = 4,
+                          const std::atomic<bool>* cancel = nullptr, bool apngFallback = false);
+  /**
+     * @brief 解码 EXIF 中嵌入的 JPEG 缩略图，用作占位图
+     * @param sourceWidth,sourceHeight 输出原图尺寸
+     * @return RGBA 数据（FreeImage 释放）；没有缩略图或宽高比与原图不符（带黑边）时返回 nullptr
+     */
+unsigned char* LoadExifThumbnail(const MappedFile& file, int& width, int& height, int& sourceWidth, int& sourceHeight);
+// 只读取文件头中的图像尺寸（不解码像素）
+bool ReadImageSize(const MappedFile& file, int& width, int& height);
+// 只读取元数据（不解码像素）
+ImageMetadata ReadImageMetadata(const MappedFile& file);
+ImageMetadata ReadImageMetadata(const std::string& path);
+  /**
+     * @brief 分配 RGBA 图像缓冲区，与 LoadImage 使用同一分配器，使用 FreeImage 释放
+     */
+unsigned char* AllocateImage(int width, int height);
+  /**
+     * @brief 将 RGBA 图像缩放到指定尺寸（stb_image_resize2，SIMD）
+     * @return 新分配的图像数据（使用 FreeImage 释放），失败返回 nullptr
+     */
+unsigned char* ResizeImage(const unsigned char* data, int width, int height, int newWidth, int newHeight);
+  /**
+     * @brief 将 RGBA 图像等比缩小到不超过 maxWidth x maxHeight（stb_image_resize2，SIMD）
+     * @param data 图像数据，缩放成功时原数据被释放并替换为新缓冲区
+     * @param width 输入/输出宽度
+     * @param height 输入/输出高度
+     * @return 是否进行了缩放（图像本身足够小时返回 false，数据不变）
+     */
+bool ResizeImageToFit(unsigned char*& data, int& width, int& height, int maxWidth, int maxHeight);
+
+// 图像金字塔中的一级（RGBA，由 STBI_MALLOC 分配）
+struct ImageLevel {
+    unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+};
+// 上传后的金字塔层级纹理
+struct TextureLevel {
+    int image = -1;
+    int width = 0;
+    int height = 0;
+};
+  /**
+     * @brief 由 RGBA 图像逐级减半生成缩小图，用于缩小显示时选择合适的层级
+     * @param data 原图数据（不会被修改或释放）
+     * @param minSize 长边不超过该值时停止
+     * @return 从大到小排列的层级（不含原图），使用 FreeImageLevels 释放
+     */
+std::vector<ImageLevel> BuildImagePyramid(const unsigned char* data, int width, int height, int minSize = 256);
+void FreeImageLevels(std::vector<ImageLevel>& levels);
   /**
      * @brief 安全释放由LoadImage加载的图像数据
      * @param data 图像数据指针（会被置为nullptr）
@@ -118,10 +229,27 @@ void FreeImage(unsigned char*& data, const std::string& path);
 // GIF
 unsigned char* loadGifImage(const std::string& path, int& outWidth, int& outHeight, int& channels, int& frames,std::vector<int>& outDelays) ;
 // GifImage loadGif(const std::string& path,  int& outWidth, int& outHeight,int& frame_count);
+// 逐帧解码 GIF，只保留合成下一帧所需的状态（data 在读取期间须保持有效）
+struct GifFrameReader;
+GifFrameReader* OpenGifReader(const unsigned char* data, size_t size);
+// 与上一帧相比发生变化的区域（像素坐标）
+struct FrameRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+// 合成下一帧（RGBA，画布尺寸），返回的缓冲区在下次调用前有效；结束或出错时返回 nullptr
+// changed 为本帧图像描述符与上一帧（处置方式只影响上一帧区域）的并集，第一帧为整个画布
+const unsigned char* ReadGifFrame(GifFrameReader* reader, int& width, int& height, int& delay, FrameRect* changed = nullptr);
+void RewindGifReader(GifFrameReader* reader);
+void CloseGifReader(GifFrameReader* reader);
 
 
 void enableImageCycle(size_t& current_index,size_t& limit_index, bool& is_cycle);
 bool getExifInfo(const std::string& imagPath,std::string& image_exif,int& orientation);
+// 从已映射的文件解析，与 LoadImage 共用同一份映射
+bool getExifInfo(const MappedFile& file,std::string& image_exif,int& orientation);
 int get_Orientation(int orientation);
 void playGif(int& currentFrame, int& gifFramesCount,double& m_frameTimeAccumulator,double deltaTime,std::vector<int>& gifDelays, bool& is_cycle);
 
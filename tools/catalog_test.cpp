@@ -0,0 +1,53 @@
+// 图片列表回归测试，失败时返回非 0
+// 用法: catalog_test
+#include "ImageCatalog.h"
+#include <cstdio>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);  \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (0)
+
+// 删除大目录时整理 m_arena 不能发生在逐个释放的中途，否则已删除字节数大于 m_arena 长度
+static void testEraseLargeDirectory() {
+    ImageCatalog catalog;
+    for (int i = 0; i < 10000; ++i) {
+        catalog.addUtf8("/photos/keep/" + std::to_string(i) + ".jpg");
+    }
+    for (int i = 0; i < 90000; ++i) {
+        catalog.addUtf8("/photos/drop/sub" + std::to_string(i % 10) + "/" + std::to_string(i) + ".jpg");
+    }
+    CHECK(catalog.eraseDirectory(fs::u8path("/photos/drop")) == 90000);
+    CHECK(catalog.size() == 10000);
+    CHECK(catalog.findUtf8("/photos/keep/9999.jpg") != ImageCatalog::npos);
+    CHECK(catalog.findUtf8("/photos/drop/sub0/0.jpg") == ImageCatalog::npos);
+
+    // 释放的槽位复用，之后的删除仍会整理
+    for (int i = 0; i < 90000; ++i) {
+        catalog.addUtf8("/photos/again/" + std::to_string(i) + ".jpg");
+    }
+    CHECK(catalog.eraseDirectory(fs::u8path("/photos/again")) == 90000);
+    for (int i = 0; i < 10000; i += 2) {
+        CHECK(catalog.erase(fs::u8path("/photos/keep/" + std::to_string(i) + ".jpg")));
+    }
+    CHECK(catalog.size() == 5000);
+    for (size_t i = 0; i < catalog.size(); ++i) {
+        CHECK(catalog.findUtf8(catalog.pathView(i)) == i);
+    }
+}
+
+int main() {
+    testEraseLargeDirectory();
+    if (failures != 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
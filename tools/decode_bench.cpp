@@ -0,0 +1,81 @@
+// 解码性能测试：对目录中的每张图片用所有可用的解码器解码，输出各解码器的吞吐量
+// 用法: decode_bench <图片目录> [重复次数]
+#include "utils.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "PixelPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct BenchResult {
+    int files = 0;
+    int failures = 0;
+    double megapixels = 0.0;
+    double seconds = 0.0;
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Usage: %s <image directory> [iterations]\n", argv[0]);
+        return 1;
+    }
+    fs::path directory = argv[1];
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+
+    std::vector<fs::path> paths;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file()) {
+            paths.push_back(it->path());
+        }
+    }
+    if (paths.empty()) {
+        std::printf("No files in %s\n", directory.string().c_str());
+        return 1;
+    }
+
+    // 键为 (格式, 解码器)
+    std::map<std::pair<std::string, std::string>, BenchResult> results;
+    for (const auto& path : paths) {
+        MappedFile file(path.string());
+        if (!file.isOpen()) continue;
+        ImageFormat format = DetectImageFormat(file.data(), file.size());
+        if (format == ImageFormat::GIF) continue;
+
+        for (ImageDecoder* decoder : ImageDecoderRegistry::getInstance().getDecoders(format)) {
+            BenchResult& result = results[{ImageFormatName(format), decoder->name()}];
+            ++result.files;
+            for (int i = 0; i < iterations; ++i) {
+                int width = 0, height = 0, channels = 0;
+                auto start = std::chrono::steady_clock::now();
+                unsigned char* pixels = decoder->decode(file.data(), file.size(), width, height, channels, 4, nullptr);
+                auto end = std::chrono::steady_clock::now();
+                if (!pixels) {
+                    ++result.failures;
+                    break;
+                }
+                FreeImage(pixels, "");
+                result.seconds += std::chrono::duration<double>(end - start).count();
+                result.megapixels += static_cast<double>(width) * height / 1e6;
+            }
+        }
+    }
+
+    std::printf("%-8s %-16s %6s %6s %10s %10s %10s\n", "format", "decoder", "files", "failed", "MP", "ms/MP", "MP/s");
+    for (const auto& [key, result] : results) {
+        double msPerMegapixel = result.megapixels > 0 ? result.seconds * 1000.0 / result.megapixels : 0.0;
+        double throughput = result.seconds > 0 ? result.megapixels / result.seconds : 0.0;
+        std::printf("%-8s %-16s %6d %6d %10.1f %10.2f %10.1f\n", key.first.c_str(), key.second.c_str(),
+                    result.files, result.failures, result.megapixels, msPerMegapixel, throughput);
+    }
+    PixelPool::getInstance().printReport();
+    return 0;
+}
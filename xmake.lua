@@ -19,6 +19,17 @@ add_requires("glfw 3.3.8", {configs = {shared = true}})
 add_requires("nanovg", {configs = {shared = true}})
 add_requires("glew", {configs = {shared = true}})
 
+-- JPEG 使用 libjpeg-turbo（SIMD）解码，关闭后全部使用 stb_image
+option("libjpeg_turbo")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Decode JPEG with libjpeg-turbo")
+option_end()
+
+if has_config("libjpeg_turbo") then
+    add_requires("libjpeg-turbo")
+end
+
 -- 定义 UI 静态库目标
 target("ui")
     set_kind("static")
@@ -29,6 +40,10 @@ target("ui")
     add_files("src/TinyEXIF/*.cpp")
     add_includedirs("src", "src/component", "src/animation","src/utils","src/TinyEXIF")
     add_packages("glfw", "nanovg", "glew")
+    if has_config("libjpeg_turbo") then
+        add_packages("libjpeg-turbo", {public = true})
+        add_defines("VIMAG_WITH_LIBJPEG_TURBO")
+    end
 
 -- 手动创建多尺寸ICO：
 -- 将转换后的 `Vimag.ico` 文件放置在 `src/icons/` 目录下。
@@ -40,7 +55,7 @@ target("ui")
 target("VIMAG")
     set_kind("binary")
     add_rpathdirs("$ORIGIN")
-    add_files("src/Vimag.cpp","src/TinyEXIF/TinyEXIF.cpp","src/component/TextureCache.cpp","src/VimagApp.cpp")
+    add_files("src/Vimag.cpp","src/TinyEXIF/TinyEXIF.cpp","src/VimagApp.cpp")
     
     -- 添加Windows资源文件
     if is_plat("windows") then
@@ -71,6 +86,34 @@ target("VIMAG")
     
     add_cxxflags("/EHsc")
 
+-- 解码性能测试，不参与默认构建：xmake build decode_bench && xmake run decode_bench <图片目录>
+target("decode_bench")
+    set_kind("binary")
+    set_default(false)
+    add_rpathdirs("$ORIGIN")
+    add_files("tools/decode_bench.cpp")
+    add_deps("ui")
+    add_packages("glfw", "nanovg", "glew")
+    add_includedirs("src", "src/utils", "src/TinyEXIF")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    else
+        add_links("pthread")
+    end
+    set_optimize("fastest")
+
+-- 图片列表回归测试，不参与默认构建：xmake build catalog_test && xmake run catalog_test
+target("catalog_test")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/catalog_test.cpp", "src/utils/ImageCatalog.cpp")
+    add_includedirs("src/utils")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    else
+        add_links("pthread")
+    end
+
 -- 在 dist_package target 中直接定义函数
 target("dist_package")
     set_kind("phony")